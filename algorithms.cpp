@@ -12,15 +12,34 @@
 
 /* ... TODO ... */
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <functional>
+#include <iterator>
+#include <numeric>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
+#include <string>
+#include <thread>
 #include <tuple>
 #include <type_traits>
+#include <utility>
 
+#include <array>
 #include <deque>
 #include <iostream>
+#include <random>
+#include <unordered_set>
 #include <vector>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 using std::begin;
 using std::end;
 
@@ -28,8 +47,32 @@ template <class T>
 using unq = typename std::remove_const<
             typename std::remove_reference<T>::type>::type;
 
+// storage for optional; trivially destructible (and so a literal type,
+// usable in constant expressions) when T is
+template <class T, bool = std::is_trivially_destructible<unq<T>>::value>
+struct _optional_storage
+{
+  struct _empty_t {};
+  union { _empty_t _empty; unq<T> _value; };
+  bool  _has_value;
+  constexpr _optional_storage()           : _empty{}, _has_value(false) {}
+  constexpr _optional_storage(const T& t) : _value(t), _has_value(true) {}
+};
+
+template <class T>
+struct _optional_storage<T, false>
+{
+  using stored_t = unq<T>;
+  struct _empty_t {};
+  union { _empty_t _empty; stored_t _value; };
+  bool  _has_value;
+  constexpr _optional_storage()           : _empty{}, _has_value(false) {}
+  constexpr _optional_storage(const T& t) : _value(t), _has_value(true) {}
+  ~_optional_storage() { if (_has_value) _value.~stored_t(); }
+};
+
 template <class T>
-class optional                                                //  {{{1
+class optional : private _optional_storage<T>                 //  {{{1
 {
 public:
   using  stored_t = unq<T>;
@@ -41,9 +84,8 @@ public:
     bad_optional_access() : std::logic_error("no value") {}
   };
 private:
-  struct _empty_t {};
-  union { _empty_t _empty; stored_t _value; };
-  bool  _has_value = false;
+  using _optional_storage<T>::_value;
+  using _optional_storage<T>::_has_value;
 private:
   template<class... Args>
   void _construct(Args&&... args)
@@ -51,10 +93,9 @@ private:
     _has_value = true; }
   void _destruct() { _has_value = false; _value.~stored_t(); }
 public:
-  optional()            : _empty{} {}
-  optional(nullopt_t)   : optional() {}
-  optional(const T& t)  : _value(t), _has_value(true) {}
-  ~optional()             { reset(); }
+  constexpr optional()            : _optional_storage<T>() {}
+  constexpr optional(nullopt_t)   : optional() {}
+  constexpr optional(const T& t)  : _optional_storage<T>(t) {}
 
   optional& operator = (nullopt_t)
   { reset(); return *this; }
@@ -75,31 +116,31 @@ public:
   void reset()
   { if (_has_value) _destruct(); }
 
-  T& value() &
+  constexpr T& value() &
   { if (!_has_value) throw bad_optional_access(); return _value; }
-  const T& value() const &
+  constexpr const T& value() const &
   { if (!_has_value) throw bad_optional_access(); return _value; }
-  T&& value() &&
+  constexpr T&& value() &&
   { if (!_has_value) throw bad_optional_access(); return std::move(_value); }
-  const T&& value() const &&
+  constexpr const T&& value() const &&
   { if (!_has_value) throw bad_optional_access(); return std::move(_value); }
 
-  T& operator*() &                { return _value; }
-  const T& operator*() const &    { return _value; }
-  T&& operator*() &&              { return std::move(_value); }
-  const T&& operator*() const &&  { return std::move(_value); }
+  constexpr T& operator*() &                { return _value; }
+  constexpr const T& operator*() const &    { return _value; }
+  constexpr T&& operator*() &&              { return std::move(_value); }
+  constexpr const T&& operator*() const &&  { return std::move(_value); }
 
   template<class U>
-  T value_or(U&& d) &&
+  constexpr T value_or(U&& d) &&
   { return _has_value ? std::move(**this)
                       : static_cast<T>(std::forward<U>(d)); }
   template<class U>
-  T value_or(U&& d) const &
+  constexpr T value_or(U&& d) const &
   { return _has_value ? **this
                       : static_cast<T>(std::forward<U>(d)); }
 
-  explicit operator bool() const  { return _has_value; }
-  bool has_value()         const  { return _has_value; }
+  constexpr explicit operator bool() const  { return _has_value; }
+  constexpr bool has_value()         const  { return _has_value; }
 };                                                            //  }}}1
 
 /* ... TODO ... */
@@ -670,163 +711,2601 @@ template <class T>
 auto llist() -> LList<T, char*>
 { return LList<T, char*> (nullptr, nullptr); }
 
-// erastothenes
-// ...
+size_t _hardware_threads()
+{
+  const size_t n = std::thread::hardware_concurrency();
+  return n > 0 ? n : 1;
+}
 
-/* ... TODO ... */
+// run f(0), ..., f(n-1) on n threads (f(0) on the calling thread)
+template <class F>
+void _parallel_for(size_t n, F f)                             //  {{{1
+{
+  std::vector<std::thread> ts;
+  for (size_t i = 1; i < n; ++i) ts.emplace_back(f, i);
+  if (n > 0) f(0);
+  for (auto& t : ts) t.join();
+}                                                             //  }}}1
 
-int main()                                                    //  {{{1
+// number of threads to use for n elements w/ at least min_chunk each
+size_t _threads_for(size_t threads, size_t n, size_t min_chunk)
 {
-  using namespace std;
+  if (threads == 0) threads = _hardware_threads();
+  return std::max<size_t>(1, std::min(threads, n / min_chunk));
+}
 
-  const vector<int> a = {1 , 2 ,  3,  4,  5};
-  const deque<int>  b = {6 , 7 ,  8,  9, 10};
-  const vector<int> c = {11, 12, 13, 14, 15};
+/* --- pattern-defeating quicksort --- */
 
-  {
-    cout <<  "chain(a, b)" << endl;
-    auto xs = chain(a, b);
-    for (auto x : xs) cout << x << " ";
-    cout << endl;
+enum : size_t
+{
+  _pdq_insertion_sort_threshold     = 24,
+  _pdq_ninther_threshold            = 128,
+  _pdq_partial_insertion_sort_limit = 8,
+  _pdq_block_size                   = 64,
+};
+
+template <class It, class Comp>
+void _pdq_insertion_sort(It begin, It end, Comp comp)         //  {{{1
+{
+  if (begin == end) return;
+  for (It cur = begin + 1; cur != end; ++cur) {
+    It sift = cur, sift_1 = cur - 1;
+    if (comp(*sift, *sift_1)) {
+      unq<decltype(*cur)> tmp = std::move(*sift);
+      do { *sift-- = std::move(*sift_1); }
+      while (sift != begin && comp(tmp, *--sift_1));
+      *sift = std::move(tmp);
+    }
   }
+}                                                             //  }}}1
 
-  {
-    cout <<  "chain(a, chain(b, c))" << endl;
-    auto xs = chain(a, chain(b, c));
-    for (auto x : xs) cout << x << " ";
-    cout << endl;
+// requires an element <= all others at begin - 1
+template <class It, class Comp>
+void _pdq_unguarded_insertion_sort(It begin, It end, Comp comp) // {{{1
+{
+  if (begin == end) return;
+  for (It cur = begin + 1; cur != end; ++cur) {
+    It sift = cur, sift_1 = cur - 1;
+    if (comp(*sift, *sift_1)) {
+      unq<decltype(*cur)> tmp = std::move(*sift);
+      do { *sift-- = std::move(*sift_1); }
+      while (comp(tmp, *--sift_1));
+      *sift = std::move(tmp);
+    }
   }
+}                                                             //  }}}1
 
-  {
-    cout <<  "filter({ x % 2 == 0 }, chain(a, b))" << endl;
-    auto xs = filter([](int x){ return x % 2 == 0; }, chain(a, b));
-    for (auto x : xs) cout << x << " ";
-    cout << endl;
+// gives up (returning false) after too many elements were moved
+template <class It, class Comp>
+bool _pdq_partial_insertion_sort(It begin, It end, Comp comp) //  {{{1
+{
+  if (begin == end) return true;
+  size_t limit = 0;
+  for (It cur = begin + 1; cur != end; ++cur) {
+    It sift = cur, sift_1 = cur - 1;
+    if (comp(*sift, *sift_1)) {
+      unq<decltype(*cur)> tmp = std::move(*sift);
+      do { *sift-- = std::move(*sift_1); }
+      while (sift != begin && comp(tmp, *--sift_1));
+      *sift = std::move(tmp);
+      limit += cur - sift;
+    }
+    if (limit > _pdq_partial_insertion_sort_limit) return false;
   }
+  return true;
+}                                                             //  }}}1
 
-  {
-    cout <<  "map({ x*x }, chain(a, b))" << endl;
-    auto xs = map([](int x){ return x*x; }, chain(a, b));
-    for (auto x : xs) cout << x << " ";
-    cout << endl;
+template <class It, class Comp>
+void _pdq_sort2(It a, It b, Comp comp)
+{ if (comp(*b, *a)) std::iter_swap(a, b); }
+
+template <class It, class Comp>
+void _pdq_sort3(It a, It b, It c, Comp comp)
+{ _pdq_sort2(a, b, comp); _pdq_sort2(b, c, comp);
+  _pdq_sort2(a, b, comp); }
+
+template <class It>
+void _pdq_swap_offsets(It first, It last,                     //  {{{1
+                       const unsigned char* offsets_l,
+                       const unsigned char* offsets_r,
+                       size_t num, bool use_swaps)
+{
+  if (use_swaps) {
+    // same number of elements on both sides: swapping keeps the
+    // pairs in place
+    for (size_t i = 0; i < num; ++i)
+      std::iter_swap(first + offsets_l[i], last - offsets_r[i]);
+  } else if (num > 0) {
+    // otherwise a cyclic permutation needs fewer moves
+    It l = first + offsets_l[0], r = last - offsets_r[0];
+    unq<decltype(*first)> tmp(std::move(*l)); *l = std::move(*r);
+    for (size_t i = 1; i < num; ++i) {
+      l = first + offsets_l[i]; *r = std::move(*l);
+      r = last  - offsets_r[i]; *l = std::move(*r);
+    }
+    *r = std::move(tmp);
   }
+}                                                             //  }}}1
 
-  {
-    cout <<  "slice(chain(a, b), 0, -1, 2)" << endl;
-    auto xs = slice(chain(a, b), 0, -1, 2);
-    for (auto x : xs) cout << x << " ";
-    cout << endl;
+// partitions [begin, end) around *begin; elements equal to the pivot
+// go right; returns the pivot position and whether no swaps were needed
+template <class It, class Comp>
+std::pair<It, bool>
+_pdq_partition_right(It begin, It end, Comp comp)             //  {{{1
+{
+  unq<decltype(*begin)> pivot(std::move(*begin));
+  It first = begin, last = end;
+  while (comp(*++first, pivot));
+  if (first - 1 == begin)
+    while (first < last && !comp(*--last, pivot));
+  else
+    while (!comp(*--last, pivot));
+  const bool already_partitioned = first >= last;
+  while (first < last) {
+    std::iter_swap(first, last);
+    while ( comp(*++first, pivot));
+    while (!comp(*--last , pivot));
   }
+  It pivot_pos = first - 1;
+  *begin = std::move(*pivot_pos); *pivot_pos = std::move(pivot);
+  return std::make_pair(pivot_pos, already_partitioned);
+}                                                             //  }}}1
 
-  {
-    cout <<  "slice(chain(a, b), 3, 6, 2)" << endl;
-    auto xs = slice(chain(a, b), 3, 6, 2);
-    for (auto x : xs) cout << x << " ";
-    cout << endl;
+// same as _pdq_partition_right, but w/o branches on the comparison
+// results: the offsets of misplaced elements are collected into small
+// cache-aligned buffers (BlockQuicksort) and swapped afterwards
+template <class It, class Comp>
+std::pair<It, bool>
+_pdq_partition_right_branchless(It begin, It end, Comp comp)  //  {{{1
+{
+  unq<decltype(*begin)> pivot(std::move(*begin));
+  It first = begin, last = end;
+  while (comp(*++first, pivot));
+  if (first - 1 == begin)
+    while (first < last && !comp(*--last, pivot));
+  else
+    while (!comp(*--last, pivot));
+  const bool already_partitioned = first >= last;
+  if (!already_partitioned) {
+    std::iter_swap(first, last); ++first;
+    alignas(64) unsigned char offsets_l[_pdq_block_size];
+    alignas(64) unsigned char offsets_r[_pdq_block_size];
+    It base_l = first, base_r = last;
+    size_t num_l = 0, num_r = 0, start_l = 0, start_r = 0;
+    while (first < last) {
+      const size_t unknown = last - first;
+      const size_t split_l = num_l == 0 ? (num_r == 0 ? unknown / 2
+                                                      : unknown) : 0;
+      const size_t split_r = num_r == 0 ? unknown - split_l : 0;
+      const size_t block_l = std::min<size_t>(split_l, _pdq_block_size);
+      const size_t block_r = std::min<size_t>(split_r, _pdq_block_size);
+      for (size_t i = 0; i < block_l; ++i, ++first) {
+        offsets_l[num_l] = static_cast<unsigned char>(i);
+        num_l += !comp(*first, pivot);
+      }
+      for (size_t i = 0; i < block_r; ) {
+        offsets_r[num_r] = static_cast<unsigned char>(++i);
+        num_r += comp(*--last, pivot);
+      }
+      const size_t num = std::min(num_l, num_r);
+      _pdq_swap_offsets(base_l, base_r, offsets_l + start_l,
+                        offsets_r + start_r, num, num_l == num_r);
+      num_l -= num; num_r -= num; start_l += num; start_r += num;
+      if (num_l == 0) { start_l = 0; base_l = first; }
+      if (num_r == 0) { start_r = 0; base_r = last;  }
+    }
+    // leftovers from the last block
+    if (num_l) {
+      while (num_l--)
+        std::iter_swap(base_l + offsets_l[start_l + num_l], --last);
+      first = last;
+    }
+    if (num_r) {
+      while (num_r--)
+        std::iter_swap(base_r - offsets_r[start_r + num_r], first++);
+      last = first;
+    }
   }
+  It pivot_pos = first - 1;
+  *begin = std::move(*pivot_pos); *pivot_pos = std::move(pivot);
+  return std::make_pair(pivot_pos, already_partitioned);
+}                                                             //  }}}1
 
-  {
-    cout <<  "take_while({ x < 7 }, chain(a, b))" << endl;
-    auto xs = take_while([](int x){ return x < 7; }, chain(a, b));
-    for (auto x : xs) cout << x << " ";
-    cout << endl;
+// partitions [begin, end) around *begin; elements equal to the pivot
+// go left; used when the pivot equals the preceding element, which
+// puts all duplicates of the pivot in place at once
+template <class It, class Comp>
+It _pdq_partition_left(It begin, It end, Comp comp)           //  {{{1
+{
+  unq<decltype(*begin)> pivot(std::move(*begin));
+  It first = begin, last = end;
+  while (comp(pivot, *--last));
+  if (last + 1 == end)
+    while (first < last && !comp(pivot, *++first));
+  else
+    while (!comp(pivot, *++first));
+  while (first < last) {
+    std::iter_swap(first, last);
+    while ( comp(pivot, *--last ));
+    while (!comp(pivot, *++first));
   }
+  It pivot_pos = last;
+  *begin = std::move(*pivot_pos); *pivot_pos = std::move(pivot);
+  return pivot_pos;
+}                                                             //  }}}1
 
-  {
-    cout <<  "zip(a, b)" << endl;
-    auto xs = zip(a, b);
-    for (auto x : xs) cout << get<0>(x) << "," << get<1>(x) << " ";
-    cout << endl;
+template <bool Branchless, class It, class Comp>
+void _pdq_loop(It begin, It end, Comp comp, int bad_allowed,  //  {{{1
+               bool leftmost)
+{
+  using diff_t = typename std::iterator_traits<It>::difference_type;
+  const diff_t ins = _pdq_insertion_sort_threshold,
+               nin = _pdq_ninther_threshold;
+  while (true) {
+    const diff_t size = end - begin;
+    if (size < ins) {
+      if (leftmost) _pdq_insertion_sort(begin, end, comp);
+      else          _pdq_unguarded_insertion_sort(begin, end, comp);
+      return;
+    }
+    // pivot: median of 3 or pseudo-median of 9 (ninther), at begin
+    const diff_t s2 = size / 2;
+    if (size > nin) {
+      _pdq_sort3(begin    , begin + s2    , end - 1, comp);
+      _pdq_sort3(begin + 1, begin + (s2-1), end - 2, comp);
+      _pdq_sort3(begin + 2, begin + (s2+1), end - 3, comp);
+      _pdq_sort3(begin + (s2-1), begin + s2, begin + (s2+1), comp);
+      std::iter_swap(begin, begin + s2);
+    } else {
+      _pdq_sort3(begin + s2, begin, end - 1, comp);
+    }
+    // pivot equal to the element before this range: many duplicates
+    if (!leftmost && !comp(*(begin - 1), *begin)) {
+      begin = _pdq_partition_left(begin, end, comp) + 1;
+      continue;
+    }
+    const std::pair<It, bool> part =
+      Branchless ? _pdq_partition_right_branchless(begin, end, comp)
+                 : _pdq_partition_right(begin, end, comp);
+    const It pivot_pos = part.first;
+    const diff_t l_size = pivot_pos - begin,
+                 r_size = end - (pivot_pos + 1);
+    if (l_size < size / 8 || r_size < size / 8) {
+      // bad partition: fall back to heapsort after too many, otherwise
+      // break up patterns by swapping some elements around
+      if (--bad_allowed == 0) {
+        std::make_heap(begin, end, comp); std::sort_heap(begin, end, comp);
+        return;
+      }
+      if (l_size >= ins) {
+        std::iter_swap(begin        , begin     + l_size/4);
+        std::iter_swap(pivot_pos - 1, pivot_pos - l_size/4);
+        if (l_size > nin) {
+          std::iter_swap(begin + 1    , begin     + (l_size/4 + 1));
+          std::iter_swap(begin + 2    , begin     + (l_size/4 + 2));
+          std::iter_swap(pivot_pos - 2, pivot_pos - (l_size/4 + 1));
+          std::iter_swap(pivot_pos - 3, pivot_pos - (l_size/4 + 2));
+        }
+      }
+      if (r_size >= ins) {
+        std::iter_swap(pivot_pos + 1, pivot_pos + (1 + r_size/4));
+        std::iter_swap(end - 1      , end       - r_size/4);
+        if (r_size > nin) {
+          std::iter_swap(pivot_pos + 2, pivot_pos + (2 + r_size/4));
+          std::iter_swap(pivot_pos + 3, pivot_pos + (3 + r_size/4));
+          std::iter_swap(end - 2      , end       - (1 + r_size/4));
+          std::iter_swap(end - 3      , end       - (2 + r_size/4));
+        }
+      }
+    } else if (part.second &&
+               _pdq_partial_insertion_sort(begin, pivot_pos, comp) &&
+               _pdq_partial_insertion_sort(pivot_pos + 1, end, comp)) {
+      // no swaps needed and both sides (almost) sorted: done
+      return;
+    }
+    // recurse left, loop right
+    _pdq_loop<Branchless>(begin, pivot_pos, comp, bad_allowed, leftmost);
+    begin = pivot_pos + 1; leftmost = false;
   }
+}                                                             //  }}}1
+
+template <class T, class Comp>
+struct _is_default_compare : std::false_type {};
+template <class T>
+struct _is_default_compare<T, std::less<T>>    : std::true_type {};
+template <class T>
+struct _is_default_compare<T, std::greater<T>> : std::true_type {};
+
+// pattern-defeating quicksort; uses branchless block partitioning for
+// arithmetic types w/ std::less or std::greater
+template <class It, class Comp = std::less<unq<decltype(*It())>>>
+void pdqsort(It begin, It end, Comp comp = Comp())            //  {{{1
+{
+  using T = unq<decltype(*begin)>;
+  if (begin == end) return;
+  int log2 = 0;
+  for (auto n = end - begin; n > 1; n >>= 1) ++log2;
+  _pdq_loop<std::is_arithmetic<T>::value &&
+            _is_default_compare<T, Comp>::value>
+    (begin, end, comp, log2, true);
+}                                                             //  }}}1
 
+/* --- LSD radix sort --- */
+
+// maps keys to unsigned integers w/ the same ordering
+template <class T, class Enable = void>
+struct _radix_key {};
+
+template <class T>
+struct _radix_key<T, typename std::enable_if<
+  std::is_integral<T>::value && !std::is_same<T, bool>::value>::type>
+{
+  using type = typename std::make_unsigned<T>::type;
+  static type get(T x)
   {
-    cout <<  "zip(map({ x*x }, chain(a, b)), c)" << endl;
-    auto xs = zip(map([](int x){ return x*x; }, chain(a, b)), c);
-    for (auto x : xs) cout << get<0>(x) << "," << get<1>(x) << " ";
-    cout << endl;
+    const type sign = std::is_signed<T>::value
+                    ? type(1) << (sizeof(T) * 8 - 1) : 0;
+    return static_cast<type>(x) ^ sign;
   }
+};
 
+// (only float and double: long double is not radix sortable)
+template <class T>
+struct _radix_key<T, typename std::enable_if<
+  std::is_floating_point<T>::value &&
+  (sizeof(T) == 4 || sizeof(T) == 8)>::type>
+{
+  using type = typename std::conditional<sizeof(T) == 4, uint32_t,
+                                                        uint64_t>::type;
+  static type get(T x)
   {
-    cout << "generator(10, i > 0, i--)" << endl;
-    int i = 10;
-    auto g = generator<int>([&i](){ if (i == 0) throw StopIteration();
-                                    return i--; });
-    for (auto x : g) cout << x << " ";
-    cout << endl;
+    // negative: flip all bits; positive: flip the sign bit
+    type bits; std::memcpy(&bits, &x, sizeof bits);
+    const type sign = type(1) << (sizeof(T) * 8 - 1);
+    return bits & sign ? ~bits : bits | sign;
   }
+};
 
-  {
-    cout << "$generator(37; 1, i < 20, i+=2; 42)" << endl;
-    $generator(gen) {
-      int i = 0;
-      $gbegin(int)
-        $yield(37)
-        for (i = 1; i < 20; i+=2) $yield(i)
-        $yield(42)
-      $gend
-    } g;
-    for (auto x : generator<int>(g)) cout << x << " ";
-    cout << endl;
+template <class T, class Enable = void>
+struct _is_radix_sortable : std::false_type {};
+template <class T>
+struct _is_radix_sortable<T, typename std::enable_if<
+  sizeof(typename _radix_key<T>::type) != 0>::type>
+  : std::true_type {};
+
+// LSD radix sort (8 bits per pass) for integer and floating point
+// keys; the byte histograms for all passes are built in a single
+// (parallel) pass over the input; passes where all keys share the same
+// byte are skipped
+template <class T>
+void radix_sort(std::vector<T>& v, size_t threads = 0)        //  {{{1
+{
+  using K = _radix_key<T>;
+  constexpr size_t bytes = sizeof(typename K::type);
+  using hist_t = std::array<std::array<size_t, 256>, bytes>;
+  const size_t n = v.size();
+  if (n < 2) return;
+  threads = _threads_for(threads, n, 1 << 16);
+  std::vector<hist_t> hists(threads);
+  _parallel_for(threads, [&](size_t t) {
+    hist_t& h = hists[t];
+    for (auto& row : h) row.fill(0);
+    const size_t lo = n * t / threads, hi = n * (t+1) / threads;
+    for (size_t i = lo; i < hi; ++i) {
+      auto k = K::get(v[i]);
+      for (size_t b = 0; b < bytes; ++b, k >>= 8) ++h[b][k & 0xff];
+    }
+  });
+  hist_t& hist = hists[0];
+  for (size_t t = 1; t < threads; ++t)
+    for (size_t b = 0; b < bytes; ++b)
+      for (size_t d = 0; d < 256; ++d) hist[b][d] += hists[t][b][d];
+  std::vector<T> buf(n);
+  for (size_t b = 0; b < bytes; ++b) {
+    auto& h = hist[b];
+    if (h[K::get(v[0]) >> (b * 8) & 0xff] == n) continue;
+    size_t sum = 0;
+    for (auto& c : h) { const size_t x = c; c = sum; sum += x; }
+    for (const auto& x : v) buf[h[K::get(x) >> (b * 8) & 0xff]++] = x;
+    v.swap(buf);
   }
+}                                                             //  }}}1
 
-  {
-    cout <<  "llist(map({ x*x }, chain(a, b)))" << endl;
-    auto xs = llist(map([](int x){ return x*x; }, chain(a, b)));
-    cout << "xs[3] = " << xs[3] << ", xs[6] = " << xs[6] << endl;
-    for (auto x : xs) cout << x << " ";
-    cout << endl;
+/* --- parallel merge sort --- */
+
+// number of elements of a (w/ length m) among the first d elements of
+// the stable merge of a and b (w/ length n)
+template <class It, class Comp>
+size_t _merge_corank(size_t d, It a, size_t m, It b, size_t n,
+                     Comp comp)                               //  {{{1
+{
+  size_t lo = d > n ? d - n : 0, hi = std::min(d, m);
+  while (lo < hi) {
+    const size_t mid = lo + (hi - lo) / 2;
+    if (!comp(b[d - mid - 1], a[mid])) lo = mid + 1;
+    else                               hi = mid;
   }
+  return lo;
+}                                                             //  }}}1
 
-  {
-    cout <<  "llist(1).append({ x++ }) break at > 10" << endl;
-    auto xs = llist<int>(); auto x = 1;
-    xs.append([&x](){ return x++; });
-    for (auto x : xs) {
-      if (x > 10) break;
-      cout << x << " ";
+// stable; sorts chunks in parallel w/ std::stable_sort, then merges
+// runs pairwise; each merge is split between the available threads
+// (merge path), so all threads stay busy up to the final merge
+template <class It, class Comp = std::less<unq<decltype(*It())>>>
+void parallel_merge_sort(It first, It last,                   //  {{{1
+                         Comp comp = Comp(), size_t threads = 0)
+{
+  using T = unq<decltype(*first)>;
+  const size_t n = last - first;
+  threads = _threads_for(threads, n, 1 << 14);
+  if (threads < 2) { std::stable_sort(first, last, comp); return; }
+  std::vector<size_t> runs;
+  for (size_t t = 0; t <= threads; ++t) runs.push_back(n * t / threads);
+  _parallel_for(threads, [&](size_t t) {
+    std::stable_sort(first + runs[t], first + runs[t+1], comp);
+  });
+  std::vector<T> src(std::make_move_iterator(first),
+                     std::make_move_iterator(last)), dst(n);
+  while (runs.size() > 2) {
+    const size_t pairs = (runs.size() - 1) / 2,
+                 per   = std::max<size_t>(1, threads / pairs);
+    _parallel_for(pairs * per, [&](size_t t) {
+      const size_t p = t / per, s = t % per;
+      const size_t lo = runs[2*p], mid = runs[2*p+1], hi = runs[2*p+2];
+      const size_t m = mid - lo, k = hi - mid;
+      const size_t d0 = (m + k) * s / per, d1 = (m + k) * (s+1) / per;
+      const size_t i0 = _merge_corank(d0, &src[lo], m, &src[mid], k, comp),
+                   i1 = _merge_corank(d1, &src[lo], m, &src[mid], k, comp);
+      std::merge(std::make_move_iterator(&src[lo] + i0),
+                 std::make_move_iterator(&src[lo] + i1),
+                 std::make_move_iterator(&src[mid] + (d0 - i0)),
+                 std::make_move_iterator(&src[mid] + (d1 - i1)),
+                 &dst[lo + d0], comp);
+    });
+    std::vector<size_t> next;
+    for (size_t p = 0; p < pairs; ++p) next.push_back(runs[2*p]);
+    if ((runs.size() - 1) % 2) {
+      const size_t lo = runs[runs.size() - 2];
+      std::move(&src[lo], &src[0] + n, &dst[lo]);
+      next.push_back(lo);
     }
-    cout << endl;
+    next.push_back(n);
+    runs.swap(next); src.swap(dst);
   }
+  std::move(src.begin(), src.end(), first);
+}                                                             //  }}}1
+
+// radix sort only for keys of up to 4 bytes (w/ 8 passes it loses to
+// pdqsort even on random input), from ~1k elements on, and not for
+// (reverse) sorted input, which pdqsort handles in linear time
+template <class T, class Comp>
+void _sort_vector(std::vector<T>& v, Comp comp, std::true_type)
+{
+  if (sizeof(T) <= 4 && v.size() >= 1024 &&
+      !std::is_sorted(v.begin(), v.end()) &&
+      !std::is_sorted(v.begin(), v.end(), std::greater<T>()))
+    radix_sort(v);
+  else
+    pdqsort(v.begin(), v.end(), comp);
+}
+
+template <class T, class Comp>
+void _sort_vector(std::vector<T>& v, Comp comp, std::false_type)
+{
+  if (v.size() >= (1 << 16)) parallel_merge_sort(v.begin(), v.end(), comp);
+  else                       pdqsort(v.begin(), v.end(), comp);
+}
 
+template <class T>
+class Sorted                                                  //  {{{1
+{
+public:
+  class iterator                                              //  {{{2
   {
-    cout <<  "llist(1).append({ x++ }) stop at > 10" << endl;
-    auto xs = llist<int>(); auto x = 1;
-    xs.append([&x](){ auto y = x++; if(y > 10) throw StopIteration();
-                      return y; });
-    for (auto x : xs) {
-      cout << x << " ";
+  private:
+    Sorted c; size_t n;
+  public:
+    iterator(Sorted c) : c(c), n(0) {}
+    bool not_at_end()
+    {
+      return n < c.data->size();
     }
-    cout << endl;
+    bool operator != (const iterator&)
+    {
+      return not_at_end();
+    }
+    void operator++()
+    {
+      if (not_at_end()) ++n;
+    }
+    const unq<T>& operator*()
+    {
+      if (not_at_end()) return (*c.data)[n];
+      throw std::out_of_range(
+        "Sorted::iterator::operator*(): end reached");
+    }
+  };                                                          //  }}}2
+private:
+  std::shared_ptr<const std::vector<unq<T>>> data;
+public:
+  Sorted(std::shared_ptr<const std::vector<unq<T>>> data)
+    : data(data) {}
+  Sorted(const Sorted&) = default;
+  iterator begin() { return iterator(*this); }
+  iterator end()   { return iterator(*this); }
+};                                                            //  }}}1
+
+// radix sort for (small) integer/floating point keys w/ std::less,
+// parallel merge sort for large inputs, pdqsort otherwise
+template <class Seq, class Comp>
+auto sorted(Seq&& seq, Comp comp)                             //  {{{1
+  -> Sorted<decltype(*begin(seq))>
+{
+  using T = unq<decltype(*begin(seq))>;
+  std::shared_ptr<std::vector<T>> data(new std::vector<T>);
+  for (auto x : seq) data->push_back(x);
+  _sort_vector(*data, comp, std::integral_constant<bool,
+    _is_radix_sortable<T>::value &&
+    std::is_same<Comp, std::less<T>>::value>());
+  return Sorted<decltype(*begin(seq))>(data);
+}                                                             //  }}}1
+
+template <class Seq>
+auto sorted(Seq&& seq) -> Sorted<decltype(*begin(seq))>
+{ return sorted(seq, std::less<unq<decltype(*begin(seq))>>()); }
+
+/* --- search index --- */
+
+// allocator for cache-line (or otherwise) aligned storage
+template <class T, size_t Align = 64>
+struct _aligned_allocator                                     //  {{{1
+{
+  using value_type = T;
+  template <class U> struct rebind
+  { using other = _aligned_allocator<U, Align>; };
+  _aligned_allocator() = default;
+  template <class U>
+  _aligned_allocator(const _aligned_allocator<U, Align>&) {}
+  T* allocate(size_t n)
+  {
+    // over-allocate and keep the original pointer just before the
+    // aligned block
+    char* raw = static_cast<char*>(
+      ::operator new(n * sizeof(T) + Align + sizeof(void*)));
+    uintptr_t p = reinterpret_cast<uintptr_t>(raw + sizeof(void*));
+    p = (p + Align - 1) & ~uintptr_t(Align - 1);
+    reinterpret_cast<void**>(p)[-1] = raw;
+    return reinterpret_cast<T*>(p);
   }
+  void deallocate(T* p, size_t)
+  { ::operator delete(reinterpret_cast<void**>(p)[-1]); }
+  template <class U>
+  bool operator == (const _aligned_allocator<U, Align>&) const
+  { return true; }
+  template <class U>
+  bool operator != (const _aligned_allocator<U, Align>&) const
+  { return false; }
+};                                                            //  }}}1
 
-  const vector<int> init = {0,1}; int i = 0;
-  auto fibs = llist(init);
-  fibs.append([&fibs,&i](){ ++i; return fibs[i-1] + fibs[i]; });
+template <class T>
+using _aligned_vector = std::vector<T, _aligned_allocator<T>>;
+
+#if defined(__GNUC__) || defined(__clang__)
+#  define _prefetch(p)  __builtin_prefetch(p)
+#else
+#  define _prefetch(p)  ((void) 0)
+#endif
 
+// number of searches interleaved by lower_bound_many()
+enum : size_t { _search_batch = 16 };
+
+// static sorted index; lower_bound() uses a branchless binary search
+// over the sorted array or, after eytzinger(), over a copy in BFS order
+// (Eytzinger layout) w/ software prefetching, which keeps the top of
+// the tree in cache and fetches 4 levels ahead
+template <class T>
+class SearchIndex                                             //  {{{1
+{
+public:
+  using value_type = unq<T>;
+  using const_iterator = typename std::vector<value_type>::const_iterator;
+private:
+  std::vector<value_type> data;
+  _aligned_vector<value_type> eytz;       // 1-based, BFS order
+  std::vector<size_t> rank;               // eytz index -> data index
+private:
+  size_t _fill(size_t i, size_t k)
   {
-    cout << "fibs" << endl;
-    for (auto x : fibs(10)) cout << x << " ";
-    cout << endl;
+    if (k <= data.size()) {
+      i = _fill(i, 2*k); eytz[k] = data[i]; rank[k] = i++;
+      i = _fill(i, 2*k + 1);
+    }
+    return i;
+  }
+  // elements per cache line: children 4 levels down (for 16 per line)
+  // share one line
+  static constexpr size_t _per_line()
+  { return sizeof(value_type) >= 64 ? 1 : 64 / sizeof(value_type); }
+  size_t _eytz_result(size_t k) const
+  {
+    // undo the trailing right turns (and the last left one)
+    while (k & 1) k >>= 1;
+    return rank[k >> 1];
   }
+public:
+  SearchIndex(std::vector<value_type>&& data) : data(std::move(data)) {}
+  SearchIndex(const SearchIndex&) = default;
+  SearchIndex(SearchIndex&&) = default;
 
+  // build the Eytzinger layout (once); used by all later lookups
+  SearchIndex& eytzinger()
   {
-    cout <<  "llist(map({ x*x }, fibs))" << endl;
-    auto xs = llist(map([](int x){ return x*x; }, fibs))(10);
-    for (auto x : xs) cout << x << " ";
-    cout << endl;
+    if (eytz.empty()) {
+      eytz.resize(data.size() + 1); rank.resize(data.size() + 1);
+      rank[0] = data.size(); _fill(0, 1);
+    }
+    return *this;
   }
+  bool has_eytzinger() const { return !eytz.empty(); }
+
+  size_t size() const { return data.size(); }
+  const value_type& operator[](size_t i) const { return data[i]; }
+  const_iterator begin() const { return data.begin(); }
+  const_iterator end()   const { return data.end(); }
 
+  // index of the first element >= key (or size())
+  size_t lower_bound(const value_type& key) const
   {
-    cout << "fibs2" << endl;
-    auto fibs2 = llist(fibs);
-    for (auto x : fibs2(15)) cout << x << " ";
-    cout << endl;
+    const size_t n = data.size();
+    if (has_eytzinger()) {
+      const value_type* b = eytz.data(); size_t k = 1;
+      while (k <= n) {
+        _prefetch(b + std::min(k * _per_line(), n));
+        k = 2*k + (b[k] < key);
+      }
+      return _eytz_result(k);
+    }
+    if (n == 0) return 0;
+    const value_type* base = data.data(); size_t len = n;
+    while (len > 1) {
+      const size_t half = len / 2;
+      base = base[half] < key ? base + half : base; len -= half;
+    }
+    return (base - data.data()) + (*base < key);
+  }
+  bool contains(const value_type& key) const
+  {
+    const size_t i = lower_bound(key);
+    return i < data.size() && !(key < data[i]);
   }
 
+  // lower_bound() for each key; searches are run in lockstep in
+  // batches, so the cache misses of one overlap w/ the others
+  template <class Seq>
+  std::vector<size_t> lower_bound_many(Seq&& keys) const
   {
-    cout << "sliced fibs" << endl;
-    for (auto x : fibs(0, 17, 2)) cout << x << " ";
-    cout << endl;
+    std::vector<value_type> ks; for (auto x : keys) ks.push_back(x);
+    std::vector<size_t> out(ks.size());
+    const size_t n = data.size(), m = ks.size();
+    size_t levels = 0; for (size_t x = n; x > 0; x >>= 1) ++levels;
+    for (size_t i = 0; i < m; i += _search_batch) {
+      const size_t g = std::min<size_t>(_search_batch, m - i);
+      const value_type* key = &ks[i];
+      if (has_eytzinger()) {
+        const value_type* b = eytz.data(); size_t k[_search_batch];
+        for (size_t j = 0; j < g; ++j) k[j] = 1;
+        for (size_t l = 0; l < levels; ++l)
+          for (size_t j = 0; j < g; ++j) {
+            if (k[j] > n) continue;
+            _prefetch(b + std::min(k[j] * _per_line(), n));
+            k[j] = 2*k[j] + (b[k[j]] < key[j]);
+          }
+        for (size_t j = 0; j < g; ++j) out[i+j] = _eytz_result(k[j]);
+      } else if (n == 0) {
+        for (size_t j = 0; j < g; ++j) out[i+j] = 0;
+      } else {
+        // every search takes the same number of steps for a given n
+        const value_type* base[_search_batch];
+        for (size_t j = 0; j < g; ++j) base[j] = data.data();
+        for (size_t len = n; len > 1; ) {
+          const size_t half = len / 2; len -= half;
+          for (size_t j = 0; j < g; ++j) {
+            _prefetch(base[j] + len / 2);
+            _prefetch(base[j] + half + len / 2);
+            base[j] = base[j][half] < key[j] ? base[j] + half : base[j];
+          }
+        }
+        for (size_t j = 0; j < g; ++j)
+          out[i+j] = (base[j] - data.data()) + (*base[j] < key[j]);
+      }
+    }
+    return out;
+  }
+};                                                            //  }}}1
+
+template <class Seq>
+auto search_index(Seq&& seq)                                  //  {{{1
+  -> SearchIndex<decltype(*begin(seq))>
+{
+  using T = unq<decltype(*begin(seq))>;
+  std::vector<T> data; for (auto x : seq) data.push_back(x);
+  _sort_vector(data, std::less<T>(), std::integral_constant<bool,
+    _is_radix_sortable<T>::value>());
+  return SearchIndex<decltype(*begin(seq))>(std::move(data));
+}                                                             //  }}}1
+
+/* --- d-ary heap & top-k --- */
+
+// implicit d-ary heap (a max-heap w/ std::less, like
+// std::priority_queue); the array starts w/ D-1 unused slots and is
+// cache-line aligned, so the D children of a node (at D*(i+1) ...
+// D*(i+1)+D-1 physically) share a cache line when D*sizeof(T) == 64
+template <class T, size_t D = 4, class Comp = std::less<T>>
+class DaryHeap                                                //  {{{1
+{
+  static_assert(D >= 2, "DaryHeap: D < 2");
+private:
+  static constexpr size_t off = D - 1;
+  _aligned_vector<T> data; Comp comp;
+private:
+  void sift_up(size_t i)
+  {
+    T x = std::move(data[i + off]);
+    while (i > 0) {
+      const size_t p = (i - 1) / D;
+      if (!comp(data[p + off], x)) break;
+      data[i + off] = std::move(data[p + off]); i = p;
+    }
+    data[i + off] = std::move(x);
+  }
+  void sift_down(size_t i)
+  {
+    const size_t n = size(); T x = std::move(data[i + off]);
+    while (true) {
+      const size_t first = D * i + 1;
+      if (first >= n) break;
+      const size_t last = std::min(first + D, n);
+      size_t best = first;
+      for (size_t c = first + 1; c < last; ++c)
+        if (comp(data[best + off], data[c + off])) best = c;
+      if (!comp(x, data[best + off])) break;
+      data[i + off] = std::move(data[best + off]); i = best;
+    }
+    data[i + off] = std::move(x);
+  }
+public:
+  DaryHeap(Comp comp = Comp()) : data(off), comp(comp) {}
+  DaryHeap(const DaryHeap&) = default;
+  DaryHeap(DaryHeap&&) = default;
+
+  size_t size()  const { return data.size() - off; }
+  bool   empty() const { return size() == 0; }
+  void   reserve(size_t n) { data.reserve(n + off); }
+
+  const T& top() const
+  {
+    if (empty()) throw std::out_of_range("DaryHeap::top(): empty");
+    return data[off];
+  }
+  void push(T x)
+  {
+    data.push_back(std::move(x)); sift_up(size() - 1);
+  }
+  T pop()
+  {
+    if (empty()) throw std::out_of_range("DaryHeap::pop(): empty");
+    T x = std::move(data[off]);
+    if (size() > 1) { data[off] = std::move(data.back()); }
+    data.pop_back();
+    if (!empty()) sift_down(0);
+    return x;
+  }
+  // pop() followed by push(), w/ a single sift
+  void replace_top(T x)
+  {
+    if (empty()) throw std::out_of_range("DaryHeap::replace_top(): empty");
+    data[off] = std::move(x); sift_down(0);
+  }
+  // moves the elements out (in heap order), leaving the heap empty
+  std::vector<T> take()
+  {
+    std::vector<T> xs(std::make_move_iterator(data.begin() + off),
+                      std::make_move_iterator(data.end()));
+    data.resize(off);
+    return xs;
+  }
+};                                                            //  }}}1
+
+// orders (value, index) pairs by value, then by position in the input,
+// so equal elements keep their input order
+template <class T, class Comp>
+struct _indexed_comp
+{
+  Comp comp;
+  bool operator()(const std::pair<T, size_t>& a,
+                  const std::pair<T, size_t>& b) const
+  {
+    return comp(a.first, b.first) ||
+           (!comp(b.first, a.first) && a.second < b.second);
+  }
+};
+
+// keeps the first k elements (in comp order) of [first, last), w/
+// indices starting at i; the top of the heap is the worst one kept,
+// and once the heap is full anything not better than a cached copy of
+// it is rejected w/o touching the heap
+template <class T, class It, class Comp>
+void _top_k_into(DaryHeap<std::pair<T, size_t>, 4,            //  {{{1
+                          _indexed_comp<T, Comp>>& heap,
+                 It first, It last, size_t i, size_t k, Comp comp)
+{
+  if (k == 0) return;
+  for (; first != last && heap.size() < k; ++first, ++i)
+    heap.push(std::make_pair(T(*first), i));
+  if (!(first != last)) return;
+  T threshold = heap.top().first;
+  for (; first != last; ++first, ++i) {
+    T x = *first;
+    if (!comp(x, threshold)) continue;
+    heap.replace_top(std::make_pair(std::move(x), i));
+    threshold = heap.top().first;
+  }
+}                                                             //  }}}1
+
+template <class T, class Comp>
+Sorted<T> _top_k_result(std::vector<std::pair<unq<T>, size_t>>& xs,
+                        size_t k, Comp comp)
+{
+  std::sort(xs.begin(), xs.end(), _indexed_comp<unq<T>, Comp>{comp});
+  std::shared_ptr<std::vector<unq<T>>> data(new std::vector<unq<T>>);
+  for (size_t i = 0; i < xs.size() && i < k; ++i)
+    data->push_back(std::move(xs[i].first));
+  return Sorted<T>(data);
+}
+
+// the first k elements of seq in comp order (sorted, stable); only k
+// elements are kept in memory, so seq may be a huge lazy stream
+template <class Seq, class Comp>
+auto top_k(Seq&& seq, size_t k, Comp comp)                    //  {{{1
+  -> Sorted<decltype(*begin(seq))>
+{
+  using T = unq<decltype(*begin(seq))>;
+  DaryHeap<std::pair<T, size_t>, 4, _indexed_comp<T, Comp>>
+    heap(_indexed_comp<T, Comp>{comp});
+  _top_k_into(heap, begin(seq), end(seq), 0, k, comp);
+  auto xs = heap.take();
+  return _top_k_result<decltype(*begin(seq))>(xs, k, comp);
+}                                                             //  }}}1
+
+template <class Seq>
+auto top_k(Seq&& seq, size_t k) -> Sorted<decltype(*begin(seq))>
+{ return top_k(seq, k, std::less<unq<decltype(*begin(seq))>>()); }
+
+template <class Seq>
+auto nsmallest(Seq&& seq, size_t k) -> Sorted<decltype(*begin(seq))>
+{ return top_k(seq, k, std::less<unq<decltype(*begin(seq))>>()); }
+
+template <class Seq>
+auto nlargest(Seq&& seq, size_t k) -> Sorted<decltype(*begin(seq))>
+{ return top_k(seq, k, std::greater<unq<decltype(*begin(seq))>>()); }
+
+// top_k() for random access sequences: each thread keeps a heap for
+// its chunk, the results are merged; the result is the same as
+// top_k()'s (including the order of equal elements)
+template <class Seq, class Comp =
+            std::less<unq<decltype(*begin(std::declval<Seq&>()))>>>
+auto parallel_top_k(Seq&& seq, size_t k,                      //  {{{1
+                    Comp comp = Comp(), size_t threads = 0)
+  -> Sorted<decltype(*begin(seq))>
+{
+  using T = unq<decltype(*begin(seq))>;
+  using heap_t = DaryHeap<std::pair<T, size_t>, 4,
+                          _indexed_comp<T, Comp>>;
+  const auto first = begin(seq);
+  const size_t n = end(seq) - first;
+  threads = _threads_for(threads, n, 1 << 14);
+  std::vector<heap_t> heaps(threads,
+                            heap_t(_indexed_comp<T, Comp>{comp}));
+  _parallel_for(threads, [&](size_t t) {
+    const size_t lo = n * t / threads, hi = n * (t+1) / threads;
+    heaps[t].reserve(std::min(k, hi - lo));
+    _top_k_into(heaps[t], first + lo, first + hi, lo, k, comp);
+  });
+  std::vector<std::pair<T, size_t>> xs;
+  for (auto& h : heaps) {
+    auto ys = h.take();
+    std::move(ys.begin(), ys.end(), std::back_inserter(xs));
+  }
+  return _top_k_result<decltype(*begin(seq))>(xs, k, comp);
+}                                                             //  }}}1
+
+/* --- memoize --- */
+
+struct MemoStats { size_t hits, misses, evictions; };
+
+// bounded memoization cache: a flat, open-addressing table where a key
+// may only live in the slots of the bucket its hash selects, so a
+// lookup probes a single bucket; buckets are cache-line aligned and
+// have as many slots (up to 8) as fit in one line w/ the metadata
+// bytes (at least 1, for large keys/values); a full bucket evicts w/ CLOCK
+// (second chance) on its slots; in shared mode the buckets are guarded
+// by striped locks and the cache may be used from several threads
+template <class K, class V, class Hash = std::hash<K>>
+class MemoCache                                               //  {{{1
+{
+private:
+  // metadata and padding take at most 2 * align bytes
+  static constexpr size_t _align = alignof(K) > alignof(V) ? alignof(K)
+                                                            : alignof(V),
+                          _fit   = _align >= 32 ? 0
+                                 : (64 - 2 * _align) / (sizeof(K) + sizeof(V)),
+                          ways   = _fit < 1 ? 1 : _fit > 8 ? 8 : _fit;
+  struct alignas(64) bucket
+  {
+    uint8_t used = 0, ref = 0, hand = 0;
+    K keys[ways]; V values[ways];
+  };
+  static_assert(_fit == 0 || sizeof(bucket) == 64,
+                "MemoCache: bucket is not a single cache line");
+  struct stripe
+  {
+    std::mutex m; size_t hits = 0, misses = 0, evictions = 0;
+    char _pad[64];                        // no false sharing
+  };
+  _aligned_vector<bucket> buckets; std::vector<stripe> stripes;
+  const bool shared; const Hash hash;
+private:
+  size_t _bucket(const K& k) const
+  {
+    // fibonacci hashing: spreads weak hashes (e.g. std::hash<int>)
+    return (uint64_t(hash(k)) * 0x9e3779b97f4a7c15ULL) >> 32
+           & (buckets.size() - 1);
+  }
+  static bool _find(const bucket& b, const K& k, size_t& w)
+  {
+    for (w = 0; w < ways; ++w)
+      if ((b.used >> w & 1) && b.keys[w] == k) return true;
+    return false;
+  }
+  std::unique_lock<std::mutex> _lock(stripe& s)
+  {
+    return shared ? std::unique_lock<std::mutex>(s.m)
+                  : std::unique_lock<std::mutex>();
+  }
+public:
+  MemoCache(size_t capacity, bool shared = false, Hash hash = Hash())
+    : stripes(shared ? 64 : 1), shared(shared), hash(hash)
+  {
+    size_t n = 1;
+    while (n * ways < capacity) n <<= 1;
+    buckets.resize(n);
+  }
+  MemoCache(const MemoCache&) = delete;
+
+  size_t capacity() const { return buckets.size() * ways; }
+  bool is_shared() const { return shared; }
+
+  // the cached f(k), calling (and caching) f(k) on a miss; f is
+  // called w/o holding a lock
+  template <class F>
+  V get(const K& k, F& f)
+  {
+    const size_t i = _bucket(k); bucket& b = buckets[i];
+    stripe& s = stripes[i & (stripes.size() - 1)]; size_t w;
+    {
+      auto lock = _lock(s);
+      if (_find(b, k, w)) {
+        ++s.hits; b.ref |= uint8_t(1 << w); return b.values[w];
+      }
+      ++s.misses;
+    }
+    V v = f(k);
+    auto lock = _lock(s);
+    if (_find(b, k, w)) return b.values[w];   // inserted meanwhile
+    if (b.used != 0xff >> (8 - ways)) {
+      for (w = 0; b.used >> w & 1; ++w);
+    } else {
+      while (b.ref >> b.hand & 1) {
+        b.ref &= uint8_t(~(1 << b.hand)); b.hand = (b.hand + 1) % ways;
+      }
+      w = b.hand; b.hand = (b.hand + 1) % ways; ++s.evictions;
+    }
+    b.keys[w] = k; b.values[w] = v;
+    b.used |= uint8_t(1 << w); b.ref &= uint8_t(~(1 << w));
+    return v;
+  }
+
+  MemoStats stats()
+  {
+    MemoStats r = { 0, 0, 0 };
+    for (auto& s : stripes) {
+      auto lock = _lock(s);
+      r.hits += s.hits; r.misses += s.misses; r.evictions += s.evictions;
+    }
+    return r;
+  }
+};                                                            //  }}}1
+
+template <class F, class T, class It>
+class MemoMap                                                 //  {{{1
+{
+public:
+  using key_t   = unq<decltype(*std::declval<It&>())>;
+  using cache_t = MemoCache<key_t, unq<T>>;
+  class iterator                                              //  {{{2
+  {
+  private:
+    MemoMap c;
+  public:
+    iterator(MemoMap c) : c(c) {}
+    bool not_at_end()
+    {
+      return c.it != c.end_;
+    }
+    bool operator != (const iterator&)
+    {
+      return not_at_end();
+    }
+    void operator++()
+    {
+      if (not_at_end()) ++c.it;
+    }
+    unq<T> operator*()
+    {
+      if (not_at_end()) return c.cache_->get(*c.it, c.f);
+      else throw std::out_of_range(
+        "MemoMap::iterator::operator*(): end reached");
+    }
+  };                                                          //  }}}2
+private:
+  F f; It it; const It end_; std::shared_ptr<cache_t> cache_;
+public:
+  MemoMap(F f, const It& begin, const It& end_,
+          std::shared_ptr<cache_t> cache_)
+    : f(f), it(begin), end_(end_), cache_(cache_) {}
+  MemoMap(const MemoMap&) = default;
+  iterator begin() { return iterator(*this); }
+  iterator end()   { return iterator(*this); }
+  std::shared_ptr<cache_t> cache() const { return cache_; }
+  MemoStats stats() const { return cache_->stats(); }
+};                                                            //  }}}1
+
+// map() that caches up to (about) capacity results of f
+template <class F, class Seq>
+auto memo_map(F f, Seq&& seq, size_t capacity)                //  {{{1
+  -> MemoMap<F, decltype(f(*begin(seq))), decltype(begin(seq))>
+{
+  using M = MemoMap<F, decltype(f(*begin(seq))), decltype(begin(seq))>;
+  return M(f, begin(seq), end(seq),
+           std::make_shared<typename M::cache_t>(capacity));
+}                                                             //  }}}1
+
+// memo_map() w/ a given (e.g. shared, thread-safe) cache
+template <class F, class Seq, class K, class V>
+auto memo_map(F f, Seq&& seq,                                 //  {{{1
+              std::shared_ptr<MemoCache<K, V>> cache)
+  -> MemoMap<F, decltype(f(*begin(seq))), decltype(begin(seq))>
+{
+  return MemoMap<F, decltype(f(*begin(seq))), decltype(begin(seq))>
+    (f, begin(seq), end(seq), cache);
+}                                                             //  }}}1
+
+/* --- windows, chunks & rolling aggregates --- */
+
+// non-owning view of n contiguous elements
+template <class T>
+class Span                                                    //  {{{1
+{
+private:
+  const T* data_; size_t size_;
+public:
+  Span(const T* data_, size_t size_) : data_(data_), size_(size_) {}
+  const T* begin() const { return data_; }
+  const T* end()   const { return data_ + size_; }
+  const T* data()  const { return data_; }
+  size_t   size()  const { return size_; }
+  const T& operator[](size_t i) const { return data_[i]; }
+};                                                            //  }}}1
+
+// sliding windows of n elements; each window is a Span into a buffer
+// of (up to) 2n elements owned by the iterator (valid until it is
+// advanced): when the buffer is full, the last n-1 elements are moved
+// to the front, so windows stay contiguous at O(1) amortized cost per
+// element; the buffer grows w/ the input, so a large n costs nothing
+// for a short sequence
+template <class T, class It>
+class Windows                                                 //  {{{1
+{
+public:
+  class iterator                                              //  {{{2
+  {
+  private:
+    Windows c; std::vector<unq<T>> buf; size_t pos, k; bool peeked, has;
+  private:
+    void peek()
+    {
+      if (!peeked) {
+        peeked = true; has = false;
+        while (c.it != c.end_) {
+          if (pos == 2 * c.n) {
+            std::move(buf.end() - (c.n - 1), buf.end(), buf.begin());
+            pos = c.n - 1;
+          }
+          if (pos == buf.size()) buf.push_back(*c.it);
+          else                   buf[pos] = *c.it;
+          ++pos; ++c.it;
+          if (++k >= c.n) { has = true; break; }
+        }
+      }
+    }
+  public:
+    iterator(Windows c)
+      : c(c), buf(), pos(0), k(0), peeked(false), has(false) {}
+    bool not_at_end()
+    {
+      peek(); return has;
+    }
+    bool operator != (const iterator&)
+    {
+      return not_at_end();
+    }
+    void operator++()
+    {
+      if (not_at_end()) peeked = false;
+    }
+    Span<unq<T>> operator*()
+    {
+      if (not_at_end()) return Span<unq<T>>(&buf[pos - c.n], c.n);
+      throw std::out_of_range(
+        "Windows::iterator::operator*(): end reached");
+    }
+  };                                                          //  }}}2
+private:
+  It it; const It end_; const size_t n;
+public:
+  Windows(const It& begin, const It& end_, size_t n)
+    : it(begin), end_(end_), n(n)
+  {
+    if (n == 0) throw std::invalid_argument("Windows(): n == 0");
+  }
+  Windows(const Windows&) = default;
+  iterator begin() { return iterator(*this); }
+  iterator end()   { return iterator(*this); }
+};                                                            //  }}}1
+
+template <class Seq>
+auto windows(Seq&& seq, size_t n)                             //  {{{1
+  -> Windows<decltype(*begin(seq)), decltype(begin(seq))>
+{
+  return Windows<decltype(*begin(seq)), decltype(begin(seq))>
+    (begin(seq), end(seq), n);
+}                                                             //  }}}1
+
+// consecutive chunks of n elements (the last one may be shorter); each
+// chunk is a Span into a buffer owned by the iterator, which grows w/
+// the input (up to n elements)
+template <class T, class It>
+class Chunks                                                  //  {{{1
+{
+public:
+  class iterator                                              //  {{{2
+  {
+  private:
+    Chunks c; std::vector<unq<T>> buf; size_t k; bool peeked;
+  private:
+    void peek()
+    {
+      if (!peeked) {
+        peeked = true;
+        for (k = 0; k < c.n && c.it != c.end_; ++k, ++c.it)
+          if (k == buf.size()) buf.push_back(*c.it);
+          else                 buf[k] = *c.it;
+      }
+    }
+  public:
+    iterator(Chunks c) : c(c), buf(), k(0), peeked(false) {}
+    bool not_at_end()
+    {
+      peek(); return k > 0;
+    }
+    bool operator != (const iterator&)
+    {
+      return not_at_end();
+    }
+    void operator++()
+    {
+      if (not_at_end()) peeked = false;
+    }
+    Span<unq<T>> operator*()
+    {
+      if (not_at_end()) return Span<unq<T>>(&buf[0], k);
+      throw std::out_of_range(
+        "Chunks::iterator::operator*(): end reached");
+    }
+  };                                                          //  }}}2
+private:
+  It it; const It end_; const size_t n;
+public:
+  Chunks(const It& begin, const It& end_, size_t n)
+    : it(begin), end_(end_), n(n)
+  {
+    if (n == 0) throw std::invalid_argument("Chunks(): n == 0");
+  }
+  Chunks(const Chunks&) = default;
+  iterator begin() { return iterator(*this); }
+  iterator end()   { return iterator(*this); }
+};                                                            //  }}}1
+
+template <class Seq>
+auto chunks(Seq&& seq, size_t n)                              //  {{{1
+  -> Chunks<decltype(*begin(seq)), decltype(begin(seq))>
+{
+  return Chunks<decltype(*begin(seq)), decltype(begin(seq))>
+    (begin(seq), end(seq), n);
+}                                                             //  }}}1
+
+// rolling aggregates: push(x) adds x and drops the element that falls
+// out of the window of the last n; value() is the aggregate; their
+// rings start empty and grow w/ the input (up to n)
+
+// for floating point T, w/ Neumaier compensation: otherwise the error
+// of adding and later subtracting a large value would stay in the sum
+template <class T>
+struct _rolling_sum
+{
+  using result_t = T;
+  std::vector<T> ring; size_t n, i; T sum, comp;
+  _rolling_sum(size_t n) : ring(), n(n), i(0), sum(), comp() {}
+  void add(const T& x, std::false_type) { sum = sum + x; }
+  void add(const T& x, std::true_type)
+  {
+    const T t = sum + x;
+    comp += std::abs(sum) >= std::abs(x) ? (sum - t) + x : (x - t) + sum;
+    sum = t;
+  }
+  void push(const T& x)
+  {
+    const std::is_floating_point<T> fp;
+    add(x, fp);
+    if (ring.size() < n) { ring.push_back(x); return; }
+    add(-ring[i], fp); ring[i] = x;
+    if (++i == n) i = 0;
+  }
+  T value() const { return sum + comp; }
+};
+
+template <class T>
+struct _rolling_mean : _rolling_sum<T>
+{
+  using result_t = double;
+  _rolling_mean(size_t n) : _rolling_sum<T>(n) {}
+  double value() const
+  { return double(_rolling_sum<T>::value()) / this->n; }
+};
+
+// monotonic deque (in a ring of up to n slots, doubled when full) of
+// the candidates for the minimum, w/ their positions; each element is
+// pushed and popped once
+template <class T, class Comp>
+struct _rolling_min
+{
+  using result_t = T;
+  std::vector<std::pair<T, size_t>> ring; size_t n, head, size, t;
+  Comp comp;
+  _rolling_min(size_t n, Comp comp)
+    : ring(), n(n), head(0), size(0), t(0), comp(comp) {}
+  std::pair<T, size_t>& at(size_t j)
+  { return ring[(head + j) % ring.size()]; }
+  void push(const T& x)
+  {
+    if (size > 0 && at(0).second + n <= t) {
+      head = (head + 1) % ring.size(); --size;
+    }
+    while (size > 0 && !comp(at(size - 1).first, x)) --size;
+    if (size == ring.size()) {
+      std::vector<std::pair<T, size_t>> r(
+        std::min(n, std::max<size_t>(1, 2 * size)));
+      for (size_t j = 0; j < size; ++j) r[j] = std::move(at(j));
+      ring.swap(r); head = 0;
+    }
+    at(size++) = std::make_pair(x, t++);
+  }
+  T value() const { return ring[head].first; }
+};
+
+template <class Agg, class It>
+class Rolling                                                 //  {{{1
+{
+public:
+  using result_t = typename Agg::result_t;
+  class iterator                                              //  {{{2
+  {
+  private:
+    Rolling c; Agg agg; size_t k; bool peeked, has;
+  private:
+    void peek()
+    {
+      if (!peeked) {
+        peeked = true; has = false;
+        while (c.it != c.end_) {
+          agg.push(*c.it); ++c.it;
+          if (++k >= c.n) { has = true; break; }
+        }
+      }
+    }
+  public:
+    iterator(Rolling c)
+      : c(c), agg(c.agg), k(0), peeked(false), has(false) {}
+    bool not_at_end()
+    {
+      peek(); return has;
+    }
+    bool operator != (const iterator&)
+    {
+      return not_at_end();
+    }
+    void operator++()
+    {
+      if (not_at_end()) peeked = false;
+    }
+    result_t operator*()
+    {
+      if (not_at_end()) return agg.value();
+      throw std::out_of_range(
+        "Rolling::iterator::operator*(): end reached");
+    }
+  };                                                          //  }}}2
+private:
+  It it; const It end_; const size_t n; const Agg agg;
+public:
+  Rolling(const It& begin, const It& end_, size_t n, const Agg& agg)
+    : it(begin), end_(end_), n(n), agg(agg)
+  {
+    if (n == 0) throw std::invalid_argument("Rolling(): n == 0");
+  }
+  Rolling(const Rolling&) = default;
+  iterator begin() { return iterator(*this); }
+  iterator end()   { return iterator(*this); }
+};                                                            //  }}}1
+
+template <class Seq>
+auto rolling_sum(Seq&& seq, size_t n)                         //  {{{1
+  -> Rolling<_rolling_sum<unq<decltype(*begin(seq))>>,
+             decltype(begin(seq))>
+{
+  using A = _rolling_sum<unq<decltype(*begin(seq))>>;
+  return Rolling<A, decltype(begin(seq))>
+    (begin(seq), end(seq), n, A(std::max<size_t>(n, 1)));
+}                                                             //  }}}1
+
+template <class Seq>
+auto rolling_mean(Seq&& seq, size_t n)                        //  {{{1
+  -> Rolling<_rolling_mean<unq<decltype(*begin(seq))>>,
+             decltype(begin(seq))>
+{
+  using A = _rolling_mean<unq<decltype(*begin(seq))>>;
+  return Rolling<A, decltype(begin(seq))>
+    (begin(seq), end(seq), n, A(std::max<size_t>(n, 1)));
+}                                                             //  }}}1
+
+template <class Seq, class Comp =
+            std::less<unq<decltype(*begin(std::declval<Seq&>()))>>>
+auto rolling_min(Seq&& seq, size_t n, Comp comp = Comp())     //  {{{1
+  -> Rolling<_rolling_min<unq<decltype(*begin(seq))>, Comp>,
+             decltype(begin(seq))>
+{
+  using A = _rolling_min<unq<decltype(*begin(seq))>, Comp>;
+  return Rolling<A, decltype(begin(seq))>
+    (begin(seq), end(seq), n, A(std::max<size_t>(n, 1), comp));
+}                                                             //  }}}1
+
+template <class Seq>
+auto rolling_max(Seq&& seq, size_t n)                         //  {{{1
+  -> Rolling<_rolling_min<unq<decltype(*begin(seq))>,
+                          std::greater<unq<decltype(*begin(seq))>>>,
+             decltype(begin(seq))>
+{
+  return rolling_min(seq, n, std::greater<unq<decltype(*begin(seq))>>());
+}                                                             //  }}}1
+
+/* --- scan & fold --- */
+
+// running op(...op(op(init, x0), x1)..., xi) for each xi (an inclusive
+// scan starting from init)
+template <class F, class T, class It>
+class Scan                                                    //  {{{1
+{
+public:
+  class iterator                                              //  {{{2
+  {
+  private:
+    Scan c; unq<T> acc; bool done;
+  private:
+    void step()
+    {
+      if (!done) { acc = c.f(acc, *c.it); done = true; }
+    }
+  public:
+    iterator(Scan c) : c(c), acc(c.init), done(false) {}
+    bool not_at_end()
+    {
+      return c.it != c.end_;
+    }
+    bool operator != (const iterator&)
+    {
+      return not_at_end();
+    }
+    void operator++()
+    {
+      if (not_at_end()) { step(); ++c.it; done = false; }
+    }
+    unq<T> operator*()
+    {
+      if (not_at_end()) { step(); return acc; }
+      else throw std::out_of_range(
+        "Scan::iterator::operator*(): end reached");
+    }
+  };                                                          //  }}}2
+private:
+  const F f; const unq<T> init; It it; const It end_;
+public:
+  Scan(F f, const T& init, const It& begin, const It& end_)
+    : f(f), init(init), it(begin), end_(end_) {}
+  Scan(const Scan&) = default;
+  iterator begin() { return iterator(*this); }
+  iterator end()   { return iterator(*this); }
+};                                                            //  }}}1
+
+template <class F, class T, class Seq>
+auto scan(F f, T init, Seq&& seq)                             //  {{{1
+  -> Scan<F, T, decltype(begin(seq))>
+{
+  return Scan<F, T, decltype(begin(seq))>(f, init, begin(seq), end(seq));
+}                                                             //  }}}1
+
+template <class F, class T, class Seq>
+T fold(F f, T init, Seq&& seq)                                //  {{{1
+{
+  for (auto x : seq) init = f(init, x);
+  return init;
+}                                                             //  }}}1
+
+// op-reduction of the non-empty range [first, last)
+template <class F, class It>
+auto _reduce_block(F f, It first, It last)                    //  {{{1
+  -> unq<decltype(*first)>
+{
+  unq<decltype(*first)> acc = *first;
+  for (++first; first != last; ++first) acc = f(acc, *first);
+  return acc;
+}                                                             //  }}}1
+
+// w/ 4 independent accumulators, which lets the compiler vectorize
+// integer sums (and breaks the dependency chain for floats)
+template <class T, class It>
+auto _reduce_block(std::plus<T> f, It first, It last)         //  {{{1
+  -> typename std::enable_if<std::is_arithmetic<T>::value, T>::type
+{
+  const size_t n = last - first; T acc[4] = { T(), T(), T(), T() };
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+    for (size_t j = 0; j < 4; ++j) acc[j] += first[i + j];
+  for (; i < n; ++i) acc[0] += first[i];
+  return f(f(acc[0], acc[1]), f(acc[2], acc[3]));
+}                                                             //  }}}1
+
+// inclusive scan of [first, last) from acc into out; returns the last
+// value
+template <class F, class T, class It, class Out>
+T _scan_block(F f, T acc, It first, It last, Out out)         //  {{{1
+{
+  for (; first != last; ++first, ++out) *out = acc = f(acc, *first);
+  return acc;
+}                                                             //  }}}1
+
+#ifdef __SSE2__
+// 32-bit sums, 4 lanes at a time: prefix sum within the register by
+// shifting and adding, plus the carry from the previous 4
+inline int32_t _scan_block(std::plus<int32_t> f, int32_t acc,   // {{{1
+                           std::vector<int32_t>::const_iterator first,
+                           std::vector<int32_t>::const_iterator last,
+                           std::vector<int32_t>::iterator out)
+{
+  const size_t n = last - first; size_t i = 0;
+  if (n == 0) return acc;                   // no &* on end iterators
+  const int32_t* in = &*first; int32_t* o = &*out;
+  __m128i carry = _mm_set1_epi32(acc);
+  for (; i + 4 <= n; i += 4) {
+    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+    x = _mm_add_epi32(x, _mm_slli_si128(x, 4));
+    x = _mm_add_epi32(x, _mm_slli_si128(x, 8));
+    x = _mm_add_epi32(x, carry);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(o + i), x);
+    carry = _mm_shuffle_epi32(x, 0xff);
+  }
+  acc = _mm_cvtsi128_si32(carry);
+  for (; i < n; ++i) o[i] = acc = f(acc, in[i]);
+  return acc;
+}                                                             //  }}}1
+#endif
+
+// scan() into a vector for random access sequences and associative f,
+// in two parallel passes: reduce each block, scan the block totals,
+// then scan each block starting from its offset
+template <class F, class T, class Seq>
+std::vector<T> parallel_scan(F f, T init, Seq&& seq,          //  {{{1
+                             size_t threads = 0)
+{
+  const auto& s = seq; const auto first = begin(s);
+  const size_t n = end(s) - first;
+  std::vector<T> out(n);
+  threads = _threads_for(threads, n, 1 << 16);
+  std::vector<T> offsets(threads, init);
+  auto lo = [&](size_t t) { return n * t / threads; };
+  if (threads > 1) {
+    std::vector<T> totals(threads);
+    _parallel_for(threads - 1, [&](size_t t) {
+      totals[t] = _reduce_block(f, first + lo(t), first + lo(t+1));
+    });
+    for (size_t t = 1; t < threads; ++t)
+      offsets[t] = f(offsets[t-1], totals[t-1]);
+  }
+  _parallel_for(threads, [&](size_t t) {
+    _scan_block(f, offsets[t], first + lo(t), first + lo(t+1),
+                out.begin() + lo(t));
+  });
+  return out;
+}                                                             //  }}}1
+
+// fold() for random access sequences and associative f
+template <class F, class T, class Seq>
+T parallel_fold(F f, T init, Seq&& seq, size_t threads = 0)   //  {{{1
+{
+  const auto& s = seq; const auto first = begin(s);
+  const size_t n = end(s) - first;
+  threads = _threads_for(threads, n, 1 << 16);
+  if (n == 0) return init;
+  std::vector<T> totals(threads);
+  _parallel_for(threads, [&](size_t t) {
+    totals[t] = _reduce_block(f, first + n * t / threads,
+                                 first + n * (t+1) / threads);
+  });
+  for (const auto& x : totals) init = f(init, x);
+  return init;
+}                                                             //  }}}1
+
+/* --- substring search --- */
+
+inline unsigned _ctz(uint32_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_ctz(x);
+#else
+  unsigned n = 0; while (!(x & 1)) { x >>= 1; ++n; } return n;
+#endif
+}
+
+// all (possibly overlapping) occurrences of pattern in text, as
+// offsets; candidates are positions where both the first and the last
+// byte of the pattern match (16 positions at a time w/ SSE2), verified
+// w/ memcmp; text must outlive the sequence
+template <class CharT>
+class FindAll                                                 //  {{{1
+{
+  static_assert(sizeof(CharT) == 1, "FindAll: CharT is not a byte");
+public:
+  class iterator                                              //  {{{2
+  {
+  private:
+    FindAll c; size_t base, next, found; uint32_t mask; bool peeked, has;
+  private:
+    // bit i set: the pattern may start at at + i
+    uint32_t candidates(size_t at) const
+    {
+      const size_t m = c.pattern.size(), last = c.size - m;
+      const char *t = reinterpret_cast<const char*>(c.text),
+                 *p = c.pattern.data();
+#ifdef __SSE2__
+      if (at + 16 <= last) {
+        const __m128i f = _mm_set1_epi8(p[0]), l = _mm_set1_epi8(p[m - 1]);
+        const __m128i a = _mm_loadu_si128(
+                            reinterpret_cast<const __m128i*>(t + at)),
+                      b = _mm_loadu_si128(
+                            reinterpret_cast<const __m128i*>(t + at + m - 1));
+        return _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, f),
+                                               _mm_cmpeq_epi8(b, l)));
+      }
+#endif
+      uint32_t r = 0;
+      for (size_t i = 0; i < 16 && at + i <= last; ++i)
+        r |= uint32_t(t[at + i] == p[0] && t[at + i + m - 1] == p[m - 1])
+             << i;
+      return r;
+    }
+    void peek()
+    {
+      if (peeked) return;
+      peeked = true; has = false;
+      const size_t m = c.pattern.size();
+      if (m > c.size) return;
+      while (true) {
+        while (mask) {
+          const size_t i = base + _ctz(mask); mask &= mask - 1;
+          if (m < 3 || !std::memcmp(c.text + i + 1, c.pattern.data() + 1,
+                                    m - 2)) {
+            found = i; has = true; return;
+          }
+        }
+        if (next > c.size - m) return;
+        base = next; mask = candidates(base); next += 16;
+      }
+    }
+  public:
+    iterator(FindAll c)
+      : c(c), base(0), next(0), found(0), mask(0), peeked(false),
+        has(false) {}
+    bool not_at_end()
+    {
+      peek(); return has;
+    }
+    bool operator != (const iterator&)
+    {
+      return not_at_end();
+    }
+    void operator++()
+    {
+      if (not_at_end()) peeked = false;
+    }
+    size_t operator*()
+    {
+      if (not_at_end()) return found;
+      throw std::out_of_range(
+        "FindAll::iterator::operator*(): end reached");
+    }
+  };                                                          //  }}}2
+private:
+  const CharT* text; size_t size; std::string pattern;
+public:
+  FindAll(const CharT* text, size_t size, const std::string& pattern)
+    : text(text), size(size), pattern(pattern)
+  {
+    if (pattern.empty())
+      throw std::invalid_argument("FindAll(): empty pattern");
+  }
+  FindAll(const FindAll&) = default;
+  iterator begin() { return iterator(*this); }
+  iterator end()   { return iterator(*this); }
+};                                                            //  }}}1
+
+inline FindAll<char> find_all(const std::string& text,
+                              const std::string& pattern)
+{ return FindAll<char>(text.data(), text.size(), pattern); }
+
+// FindAll points into text, which must outlive it
+FindAll<char> find_all(std::string&& text, const std::string&) = delete;
+
+// e.g. for memory-mapped input
+template <class CharT>
+FindAll<CharT> find_all(Span<CharT> text, const std::string& pattern)
+{ return FindAll<CharT>(text.data(), text.size(), pattern); }
+
+// Aho-Corasick automaton for a set of patterns, as a dense DFA: bytes
+// are first mapped to classes (one per byte used in some pattern, plus
+// one for all others), states are numbered in BFS order and each state
+// is a row of 32-bit next states, so matching is a single table lookup
+// per byte and the (hot) shallow states are adjacent
+class AhoCorasick                                             //  {{{1
+{
+private:
+  std::array<uint16_t, 256> cls; size_t ncls;
+  std::vector<uint32_t> delta;            // state * ncls + class
+  std::vector<int32_t> out;               // pattern ending here, or -1
+  std::vector<uint32_t> out_link;         // next state w/ output, or 0
+  std::vector<size_t> lens;
+public:
+  // (not for AhoCorasick&, which would otherwise beat the copy ctor)
+  template <class Seq, class = typename std::enable_if<
+    !std::is_same<unq<Seq>, AhoCorasick>::value>::type>
+  AhoCorasick(Seq&& patterns) : ncls(1)                       //  {{{2
+  {
+    std::vector<std::string> ps; for (auto p : patterns) ps.push_back(p);
+    cls.fill(0);
+    for (const auto& p : ps) {
+      if (p.empty())
+        throw std::invalid_argument("AhoCorasick(): empty pattern");
+      for (unsigned char ch : p) if (!cls[ch]) cls[ch] = uint16_t(ncls++);
+    }
+    // trie (0 = no edge; the root is 0 too, but never a child)
+    std::vector<uint32_t> trie(ncls); std::vector<int32_t> trie_out(1, -1);
+    for (size_t i = 0; i < ps.size(); ++i) {
+      uint32_t s = 0;
+      for (unsigned char ch : ps[i]) {
+        uint32_t& t = trie[s * ncls + cls[ch]];
+        if (!t) {
+          t = uint32_t(trie_out.size()); trie_out.push_back(-1);
+          trie.resize(trie.size() + ncls);
+        }
+        s = trie[s * ncls + cls[ch]];
+      }
+      if (trie_out[s] < 0) trie_out[s] = int32_t(i);
+      lens.push_back(ps[i].size());
+    }
+    // renumber in BFS order
+    const size_t n = trie_out.size();
+    std::vector<uint32_t> order(1, 0), id(n, 0);
+    for (size_t k = 0; k < order.size(); ++k)
+      for (size_t a = 0; a < ncls; ++a)
+        if (uint32_t t = trie[order[k] * ncls + a]) {
+          id[t] = uint32_t(order.size()); order.push_back(t);
+        }
+    delta.assign(n * ncls, 0); out.resize(n); out_link.assign(n, 0);
+    std::vector<uint32_t> fail(n, 0);
+    for (size_t s = 0; s < n; ++s) out[s] = trie_out[order[s]];
+    // BFS: goto edges, or the failure state's transition (computed
+    // already, as it is shallower)
+    for (size_t s = 0; s < n; ++s)
+      for (size_t a = 0; a < ncls; ++a) {
+        const uint32_t t = trie[order[s] * ncls + a];
+        if (t) {
+          const uint32_t u = id[t];
+          fail[u] = s ? delta[fail[s] * ncls + a] : 0;
+          out_link[u] = out[fail[u]] >= 0 ? fail[u] : out_link[fail[u]];
+          delta[s * ncls + a] = u;
+        } else {
+          delta[s * ncls + a] = s ? delta[fail[s] * ncls + a] : 0;
+        }
+      }
+  }                                                           //  }}}2
+  size_t states() const { return out.size(); }
+  size_t length(size_t pattern) const { return lens[pattern]; }
+  uint32_t step(uint32_t s, unsigned char ch) const
+  { return delta[s * ncls + cls[ch]]; }
+  int32_t output(uint32_t s) const { return out[s]; }
+  uint32_t output_link(uint32_t s) const { return out_link[s]; }
+};                                                            //  }}}1
+
+// all occurrences of any of the patterns in text, as (offset, pattern
+// index) tuples, ordered by end offset; duplicate patterns are reported
+// once (w/ the first index); text must outlive the sequence
+template <class CharT>
+class FindAny                                                 //  {{{1
+{
+  static_assert(sizeof(CharT) == 1, "FindAny: CharT is not a byte");
+public:
+  using match_t = std::tuple<size_t, size_t>;
+  class iterator                                              //  {{{2
+  {
+  private:
+    FindAny c; size_t pos; uint32_t s, o; match_t found; bool peeked, has;
+  private:
+    void report(uint32_t t)
+    {
+      const size_t p = size_t(c.ac->output(t));
+      found = std::make_tuple(pos - c.ac->length(p), p);
+      o = c.ac->output_link(t); has = true;
+    }
+    void peek()
+    {
+      if (peeked) return;
+      peeked = true; has = false;
+      if (o) { report(o); return; }
+      const unsigned char* t = reinterpret_cast<const unsigned char*>(c.text);
+      while (pos < c.size) {
+        s = c.ac->step(s, t[pos++]);
+        if (c.ac->output(s) >= 0) { report(s); return; }
+        if (c.ac->output_link(s)) { report(c.ac->output_link(s)); return; }
+      }
+    }
+  public:
+    iterator(FindAny c)
+      : c(c), pos(0), s(0), o(0), found(), peeked(false), has(false) {}
+    bool not_at_end()
+    {
+      peek(); return has;
+    }
+    bool operator != (const iterator&)
+    {
+      return not_at_end();
+    }
+    void operator++()
+    {
+      if (not_at_end()) peeked = false;
+    }
+    match_t operator*()
+    {
+      if (not_at_end()) return found;
+      throw std::out_of_range(
+        "FindAny::iterator::operator*(): end reached");
+    }
+  };                                                          //  }}}2
+private:
+  const CharT* text; size_t size; std::shared_ptr<const AhoCorasick> ac;
+public:
+  FindAny(const CharT* text, size_t size,
+          std::shared_ptr<const AhoCorasick> ac)
+    : text(text), size(size), ac(ac) {}
+  FindAny(const FindAny&) = default;
+  iterator begin() { return iterator(*this); }
+  iterator end()   { return iterator(*this); }
+};                                                            //  }}}1
+
+inline FindAny<char> find_any(const std::string& text,
+                              std::shared_ptr<const AhoCorasick> ac)
+{ return FindAny<char>(text.data(), text.size(), ac); }
+
+template <class CharT>
+FindAny<CharT> find_any(Span<CharT> text,
+                        std::shared_ptr<const AhoCorasick> ac)
+{ return FindAny<CharT>(text.data(), text.size(), ac); }
+
+inline FindAny<char> find_any(const std::string& text,
+                              const std::vector<std::string>& patterns)
+{ return find_any(text, std::make_shared<const AhoCorasick>(patterns)); }
+
+template <class CharT>
+FindAny<CharT> find_any(Span<CharT> text,
+                        const std::vector<std::string>& patterns)
+{ return find_any(text, std::make_shared<const AhoCorasick>(patterns)); }
+
+// FindAny points into text, which must outlive it
+FindAny<char> find_any(std::string&& text,
+                       std::shared_ptr<const AhoCorasick>) = delete;
+FindAny<char> find_any(std::string&& text,
+                       const std::vector<std::string>&) = delete;
+
+/* --- distinct --- */
+
+// 64-bit finalizer (splitmix64); spreads weak hashes
+inline uint64_t _mix64(uint64_t x)
+{
+  x ^= x >> 30; x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27; x *= 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+// exact set: open addressing w/ linear probing, grows at load 1/2
+template <class T, class Hash = std::hash<T>>
+class FlatSet                                                 //  {{{1
+{
+private:
+  std::vector<T> keys; std::vector<uint8_t> used; size_t size_;
+  Hash hash;
+private:
+  size_t _slot(const T& x) const
+  {
+    size_t i = _mix64(hash(x)) & (keys.size() - 1);
+    while (used[i] && !(keys[i] == x)) i = (i + 1) & (keys.size() - 1);
+    return i;
+  }
+  void _grow()
+  {
+    std::vector<T> ks(keys.size() * 2); std::vector<uint8_t> us(ks.size());
+    ks.swap(keys); us.swap(used);
+    for (size_t i = 0; i < ks.size(); ++i)
+      if (us[i]) { const size_t j = _slot(ks[i]);
+                   keys[j] = std::move(ks[i]); used[j] = 1; }
+  }
+public:
+  FlatSet(size_t expected = 16, Hash hash = Hash())
+    : size_(0), hash(hash)
+  {
+    size_t n = 16; while (n < 2 * expected) n <<= 1;
+    keys.resize(n); used.resize(n);
+  }
+  // true if x was not in the set; grows only for a new x
+  bool insert(const T& x)
+  {
+    size_t i = _slot(x);
+    if (used[i]) return false;
+    if (2 * (size_ + 1) > keys.size()) { _grow(); i = _slot(x); }
+    keys[i] = x; used[i] = 1; ++size_;
+    return true;
+  }
+  size_t size()  const { return size_; }
+  size_t bytes() const { return keys.size() * (sizeof(T) + 1); }
+};                                                            //  }}}1
+
+// blocked Bloom filter: all k bits of an element are in one 512-bit
+// (cache line) block, so a lookup costs one cache miss; sized for n
+// elements at false positive rate fp (a bit higher in practice, as
+// blocks fill unevenly)
+template <class T, class Hash = std::hash<T>>
+class BlockedBloom                                            //  {{{1
+{
+private:
+  _aligned_vector<uint64_t> bits; size_t blocks; unsigned k; Hash hash;
+public:
+  BlockedBloom(size_t n, double fp = 0.01, Hash hash = Hash())
+    : hash(hash)
+  {
+    if (!(fp > 0 && fp < 1))
+      throw std::invalid_argument("BlockedBloom(): fp not in (0, 1)");
+    const double ln2 = std::log(2.0),
+                 per = -std::log(fp) / (ln2 * ln2);   // bits/element
+    blocks = std::max<size_t>(1, size_t(std::ceil(n * per / 512)));
+    k = unsigned(std::max(1.0, std::min(16.0, std::round(per * ln2))));
+    bits.assign(blocks * 8, 0);
+  }
+  // true if x was (probably) not in the filter; never false for new x;
+  // the block comes from the high half of the hash, the bits from a
+  // second mix, so elements of the same block don't share bit patterns
+  bool insert(const T& x)
+  {
+    const uint64_t h = _mix64(hash(x)), g = _mix64(h);
+    uint64_t* b = &bits[((h >> 32) * blocks >> 32) * 8];
+    const uint32_t h1 = uint32_t(g), h2 = uint32_t(g >> 32) | 1;
+    bool fresh = false;
+    for (unsigned i = 0; i < k; ++i) {
+      const uint32_t p = (h1 + i * h2) & 511;
+      const uint64_t m = uint64_t(1) << (p & 63);
+      fresh |= !(b[p >> 6] & m); b[p >> 6] |= m;
+    }
+    return fresh;
+  }
+  unsigned hashes() const { return k; }
+  size_t   bytes()  const { return bits.size() * sizeof(uint64_t); }
+};                                                            //  }}}1
+
+// cuckoo filter: f-bit fingerprints (f from fp), 4 per bucket, each in
+// one of two buckets (partial-key cuckoo hashing); sized for n
+// elements at 95% load; when full, it drops the fingerprint that found
+// no place and is saturated(): it may then forget elements (i.e. give
+// false negatives)
+template <class T, class Hash = std::hash<T>>
+class CuckooFilter                                            //  {{{1
+{
+private:
+  enum : size_t { ways = 4, max_kicks = 500 };
+  _aligned_vector<uint16_t> slots; size_t mask; uint16_t fmask;
+  uint16_t victim; size_t victim_at; bool saturated_; uint64_t rng;
+  Hash hash;
+private:
+  size_t _alt(size_t i, uint16_t f) const
+  { return (i ^ size_t(_mix64(f))) & mask; }
+  bool _has(size_t i, uint16_t f) const
+  {
+    const uint16_t* b = &slots[i * ways];
+    return b[0] == f || b[1] == f || b[2] == f || b[3] == f;
+  }
+  bool _put(size_t i, uint16_t f)
+  {
+    uint16_t* b = &slots[i * ways];
+    for (size_t w = 0; w < ways; ++w)
+      if (!b[w]) { b[w] = f; return true; }
+    return false;
+  }
+public:
+  CuckooFilter(size_t n, double fp = 0.001, Hash hash = Hash())
+    : victim(0), victim_at(0), saturated_(false),
+      rng(0x2545f4914f6cdd1dULL), hash(hash)
+  {
+    if (!(fp > 0 && fp < 1))
+      throw std::invalid_argument("CuckooFilter(): fp not in (0, 1)");
+    // fp ~ 2 * ways / 2^f
+    const int f = int(std::max(4.0, std::min(16.0,
+                        std::ceil(std::log2(2.0 * ways / fp)))));
+    fmask = uint16_t((1u << f) - 1);
+    size_t nb = 1; while (nb * ways * 95 < n * 100) nb <<= 1;
+    mask = nb - 1; slots.assign(nb * ways, 0);
+  }
+  // true if x was (probably) not in the filter; never false for new x
+  // (but once saturated, also true for some old x)
+  bool insert(const T& x)
+  {
+    const uint64_t h = _mix64(hash(x));
+    uint16_t f = uint16_t(h >> 48) & fmask; if (!f) f = 1;
+    size_t i = h & mask; const size_t j = _alt(i, f);
+    if (_has(i, f) || _has(j, f) || (victim == f &&
+        (victim_at == i || victim_at == j)))
+      return false;
+    if (_put(i, f) || _put(j, f)) return true;
+    if ((rng ^= rng << 13, rng ^= rng >> 7, rng ^= rng << 17) & 1) i = j;
+    for (size_t n = 0; n < max_kicks; ++n) {
+      rng ^= rng << 13; rng ^= rng >> 7; rng ^= rng << 17;
+      std::swap(f, slots[i * ways + rng % ways]);
+      i = _alt(i, f);
+      if (_put(i, f)) return true;
+    }
+    if (victim) saturated_ = true;          // the old victim is lost
+    victim = f; victim_at = i;
+    return true;
+  }
+  bool   saturated() const { return saturated_; }
+  size_t bytes()     const { return slots.size() * sizeof(uint16_t); }
+};                                                            //  }}}1
+
+// elements of seq not seen before, according to Set::insert(); the
+// given (empty) set is moved into the iterator begin() returns, so a
+// Distinct can only be iterated once; copies of an iterator copy the
+// set, and set() gives access to it (e.g. CuckooFilter::saturated())
+template <class T, class It, class Set>
+class Distinct                                                //  {{{1
+{
+public:
+  class iterator                                              //  {{{2
+  {
+  private:
+    It it, end_; std::unique_ptr<Set> seen;
+    optional<const unq<T>> v; bool peeked;
+  private:
+    void peek()
+    {
+      if (!peeked) {
+        peeked = true; v.reset();
+        while (seen && it != end_) {
+          unq<T> x = *it; ++it;
+          if (seen->insert(x)) { v.emplace(x); break; }
+        }
+      }
+    }
+  public:
+    iterator(const It& it, const It& end_, std::unique_ptr<Set> seen)
+      : it(it), end_(end_), seen(std::move(seen)), v(), peeked(false) {}
+    iterator(const iterator& i)
+      : it(i.it), end_(i.end_), seen(i.seen ? new Set(*i.seen) : nullptr),
+        v(), peeked(i.peeked)
+    {
+      if (i.v) v.emplace(*i.v);
+    }
+    iterator(iterator&& i)
+      : it(i.it), end_(i.end_), seen(std::move(i.seen)), v(),
+        peeked(i.peeked)
+    {
+      if (i.v) v.emplace(*i.v);
+    }
+    bool not_at_end()
+    {
+      peek(); return v.has_value();
+    }
+    bool operator != (const iterator&)
+    {
+      return not_at_end();
+    }
+    void operator++()
+    {
+      if (not_at_end()) peeked = false;
+    }
+    unq<T> operator*()
+    {
+      if (not_at_end()) return *v;
+      throw std::out_of_range(
+        "Distinct::iterator::operator*(): end reached");
+    }
+    const Set& set() const
+    {
+      if (seen) return *seen;
+      throw std::logic_error("Distinct::iterator::set(): no set");
+    }
+  };                                                          //  }}}2
+private:
+  It it; const It end_; std::unique_ptr<Set> set;
+public:
+  Distinct(const It& begin, const It& end_, Set set)
+    : it(begin), end_(end_), set(new Set(std::move(set))) {}
+  Distinct(const Distinct& d)
+    : it(d.it), end_(d.end_), set(d.set ? new Set(*d.set) : nullptr) {}
+  Distinct(Distinct&&) = default;
+  iterator begin()
+  {
+    if (set) return iterator(it, end_, std::move(set));
+    throw std::logic_error("Distinct::begin(): already iterated");
+  }
+  iterator end() { return iterator(end_, end_, nullptr); }
+};                                                            //  }}}1
+
+// w/ a given set, e.g. a BlockedBloom or CuckooFilter
+template <class Seq, class Set>
+auto distinct(Seq&& seq, Set set)                             //  {{{1
+  -> Distinct<decltype(*begin(seq)), decltype(begin(seq)), Set>
+{
+  return Distinct<decltype(*begin(seq)), decltype(begin(seq)), Set>
+    (begin(seq), end(seq), std::move(set));
+}                                                             //  }}}1
+
+// exact
+template <class Seq>
+auto distinct(Seq&& seq)                                      //  {{{1
+  -> Distinct<decltype(*begin(seq)), decltype(begin(seq)),
+              FlatSet<unq<decltype(*begin(seq))>>>
+{
+  return distinct(seq, FlatSet<unq<decltype(*begin(seq))>>());
+}                                                             //  }}}1
+
+/* --- compile time (constexpr) subset --- */
+
+// map/filter/slice/take_while over std::array, and recurrence, usable
+// in constant expressions (so e.g. lookup tables can be computed at
+// compile time and stored in .rodata); functions must be constexpr
+// (function pointers or function objects: lambdas are not constexpr
+// before C++17); filter and take_while take the result size as a
+// template argument, see count_if and count_while
+namespace cx {
+
+// std::array is not writable in constant expressions before C++17
+template <class T, size_t N>
+struct _buf { T data[N > 0 ? N : 1]; };
+
+template <class T, size_t N, size_t... I>
+constexpr std::array<T, N>
+_to_array(const _buf<T, N>& b, std::index_sequence<I...>)
+{ return {{ b.data[I]... }}; }
+
+template <size_t N, class T = size_t>
+constexpr std::array<T, N> iota(T start = T())               //  {{{1
+{
+  _buf<T, N> b{};
+  for (size_t i = 0; i < N; ++i) b.data[i] = T(start + i);
+  return _to_array(b, std::make_index_sequence<N>());
+}                                                             //  }}}1
+
+template <class F, class T, size_t N, size_t... I>
+constexpr auto _map(F f, const std::array<T, N>& xs,
+                    std::index_sequence<I...>)
+  -> std::array<unq<decltype(f(std::declval<const T&>()))>, N>
+{ return {{ f(xs[I])... }}; }
+
+template <class F, class T, size_t N>
+constexpr auto map(F f, const std::array<T, N>& xs)           //  {{{1
+  -> std::array<unq<decltype(f(std::declval<const T&>()))>, N>
+{
+  return _map(f, xs, std::make_index_sequence<N>());
+}                                                             //  }}}1
+
+template <class F, class T, size_t N>
+constexpr size_t count_if(F f, const std::array<T, N>& xs)
+{
+  size_t n = 0;
+  for (size_t i = 0; i < N; ++i) n += f(xs[i]) ? 1 : 0;
+  return n;
+}
+
+template <class F, class T, size_t N>
+constexpr size_t count_while(F f, const std::array<T, N>& xs)
+{
+  size_t n = 0;
+  while (n < N && f(xs[n])) ++n;
+  return n;
+}
+
+// the first M elements for which f holds
+template <size_t M, class F, class T, size_t N>
+constexpr std::array<T, M>
+filter(F f, const std::array<T, N>& xs)                       //  {{{1
+{
+  _buf<T, M> b{}; size_t j = 0;
+  for (size_t i = 0; i < N && j < M; ++i)
+    if (f(xs[i])) b.data[j++] = xs[i];
+  if (j < M) throw std::out_of_range("cx::filter(): too few elements");
+  return _to_array(b, std::make_index_sequence<M>());
+}                                                             //  }}}1
+
+// the first M elements, which must all satisfy f
+template <size_t M, class F, class T, size_t N>
+constexpr std::array<T, M>
+take_while(F f, const std::array<T, N>& xs)                   //  {{{1
+{
+  if (count_while(f, xs) < M)
+    throw std::out_of_range("cx::take_while(): too few elements");
+  _buf<T, M> b{};
+  for (size_t i = 0; i < M; ++i) b.data[i] = xs[i];
+  return _to_array(b, std::make_index_sequence<M>());
+}                                                             //  }}}1
+
+template <class T, size_t N, size_t Start, size_t Step, size_t... I>
+constexpr std::array<T, sizeof...(I)>
+_slice(const std::array<T, N>& xs, std::index_sequence<I...>)
+{ return {{ xs[Start + I * Step]... }}; }
+
+// like slice(): stop = -1 is the end
+template <size_t Start, long Stop = -1, size_t Step = 1,
+          class T, size_t N,
+          size_t Stop_ = (Stop < 0 || size_t(Stop) > N ? N : Stop),
+          size_t M = (Stop_ > Start ? (Stop_ - Start + Step - 1) / Step
+                                    : 0)>
+constexpr std::array<T, M> slice(const std::array<T, N>& xs) //  {{{1
+{
+  static_assert(Step > 0, "cx::slice(): step == 0");
+  static_assert(Stop >= -1, "cx::slice(): stop < -1");
+  return _slice<T, N, Start, Step>(xs, std::make_index_sequence<M>());
+}                                                             //  }}}1
+
+template <class F, class T, size_t N, size_t... J>
+constexpr T _apply_last(F f, const _buf<T, N>& b, size_t i,
+                        std::index_sequence<J...>)
+{ return f(b.data[i - sizeof...(J) + J]...); }
+
+// N elements: the K seed values, then each the result of f applied to
+// the K before it
+template <size_t N, class F, class T, size_t K>
+constexpr std::array<T, N>
+recurrence(F f, const std::array<T, K>& seed)                 //  {{{1
+{
+  static_assert(K > 0, "cx::recurrence(): empty seed");
+  _buf<T, N> b{};
+  for (size_t i = 0; i < N; ++i)
+    b.data[i] = i < K ? seed[i]
+                      : _apply_last(f, b, i, std::make_index_sequence<K>());
+  return _to_array(b, std::make_index_sequence<N>());
+}                                                             //  }}}1
+
+// the first element for which f holds, if any
+template <class F, class T, size_t N>
+constexpr optional<T> find(F f, const std::array<T, N>& xs)   //  {{{1
+{
+  for (size_t i = 0; i < N; ++i)
+    if (f(xs[i])) return optional<T>(xs[i]);
+  return optional<T>();
+}                                                             //  }}}1
+
+}                                                             //  cx
+
+// erastothenes
+// ...
+
+/* ... TODO ... */
+
+// helpers for the cx:: examples in main()
+namespace cx_example {
+
+constexpr bool is_prime(size_t n)
+{
+  if (n < 2) return false;
+  for (size_t d = 2; d * d <= n; ++d) if (n % d == 0) return false;
+  return true;
+}
+
+constexpr uint8_t popcount(size_t x)
+{
+  uint8_t n = 0; for (; x; x &= x - 1) ++n; return n;
+}
+
+constexpr uint32_t crc32_entry(uint32_t c)
+{
+  for (int k = 0; k < 8; ++k) c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+  return c;
+}
+
+constexpr uint64_t add(uint64_t x, uint64_t y) { return x + y; }
+constexpr bool     lt_1000(uint64_t x)         { return x < 1000; }
+constexpr bool     gt_300(uint64_t x)          { return x > 300; }
+
+}                                                             //  cx_example
+
+template <class F>
+double _time_ms(F f)
+{
+  const auto t = std::chrono::steady_clock::now(); f();
+  return std::chrono::duration<double, std::milli>(
+    std::chrono::steady_clock::now() - t).count();
+}
+
+template <class T>
+void _bench_sort(const char* type)                            //  {{{1
+{
+  using namespace std;
+
+  const size_t n = 10000000;
+  mt19937_64 rng(42);
+  vector<pair<string, vector<T>>> inputs = {
+    { "random", {} }, { "sorted", {} }, { "reversed", {} },
+    { "few unique", {} }
+  };
+  for (size_t i = 0; i < n; ++i) {
+    inputs[0].second.push_back(static_cast<T>(rng()));
+    inputs[1].second.push_back(T(i));
+    inputs[2].second.push_back(T(n - i));
+    inputs[3].second.push_back(T(rng() % 16));
+  }
+  for (auto& in : inputs) {
+    cout << in.first << " (" << type << ", n = " << n << ")" << endl;
+    vector<pair<string, function<void(vector<T>&)>>> sorts = {
+      { "std::sort          ", [](vector<T>& v)
+          { sort(v.begin(), v.end()); } },
+      { "pdqsort            ", [](vector<T>& v)
+          { pdqsort(v.begin(), v.end()); } },
+      { "radix_sort         ", [](vector<T>& v)
+          { radix_sort(v); } },
+      { "parallel_merge_sort", [](vector<T>& v)
+          { parallel_merge_sort(v.begin(), v.end()); } },
+      { "sorted()           ", [](vector<T>& v)
+          { size_t i = 0; for (auto x : sorted(v)) v[i++] = x; } },
+    };
+    for (auto& s : sorts) {
+      auto v = in.second;
+      const auto ms = _time_ms([&]() { s.second(v); });
+      cout << "  " << s.first << " " << ms << " ms"
+           << (is_sorted(v.begin(), v.end()) ? "" : " (NOT SORTED)")
+           << endl;
+    }
+  }
+}                                                             //  }}}1
+
+void _bench_search()                                          //  {{{1
+{
+  using namespace std;
+
+  mt19937_64 rng(42);
+  for (size_t n : { size_t(1) << 12, size_t(1) << 20, size_t(1) << 24 }) {
+    vector<uint32_t> xs, keys; size_t sum = 0;
+    for (size_t i = 0; i < n; ++i)       xs.push_back(rng());
+    for (size_t i = 0; i < 1000000; ++i) keys.push_back(rng());
+    auto idx = search_index(xs); const auto& ys = idx;
+    cout << "search (n = " << n << ", " << keys.size() << " keys)"
+         << endl;
+    auto report = [&](const char* name, double ms) {
+      cout << "  " << name << " " << ms << " ms" << endl;
+    };
+    report("std::lower_bound       ", _time_ms([&]() {
+      for (auto k : keys)
+        sum += lower_bound(ys.begin(), ys.end(), k) - ys.begin(); }));
+    report("branchless             ", _time_ms([&]() {
+      for (auto k : keys) sum += idx.lower_bound(k); }));
+    report("branchless, batched    ", _time_ms([&]() {
+      for (auto i : idx.lower_bound_many(keys)) sum += i; }));
+    idx.eytzinger();
+    report("eytzinger              ", _time_ms([&]() {
+      for (auto k : keys) sum += idx.lower_bound(k); }));
+    report("eytzinger, batched     ", _time_ms([&]() {
+      for (auto i : idx.lower_bound_many(keys)) sum += i; }));
+    cout << "  (checksum " << sum << ")" << endl;
+  }
+}                                                             //  }}}1
+
+void _bench_scan()                                            //  {{{1
+{
+  using namespace std;
+
+  const size_t n = size_t(1) << 24;
+  vector<int32_t> xs(n), out(n); mt19937 rng(42);
+  for (auto& x : xs) x = rng() % 100;
+  cout << "scan (n = " << n << ")" << endl;
+  int32_t last = 0; double ms;
+  auto report = [&](const char* name) {
+    cout << "  " << name << " " << ms << " ms (" << last << ")" << endl;
+  };
+  ms = _time_ms([&]() { partial_sum(xs.begin(), xs.end(), out.begin());
+                        last = out.back(); });
+  report("std::partial_sum");
+  ms = _time_ms([&]() { for (auto x : scan(plus<int32_t>(), 0, xs))
+                          last = x; });
+  report("scan            ");
+  ms = _time_ms([&]() { last = parallel_scan(plus<int32_t>(), 0, xs)
+                                 .back(); });
+  report("parallel_scan   ");
+  ms = _time_ms([&]() { last = parallel_fold(plus<int32_t>(), 0, xs); });
+  report("parallel_fold   ");
+}                                                             //  }}}1
+
+void _bench_find()                                            //  {{{1
+{
+  using namespace std;
+
+  const size_t n = size_t(1) << 26;
+  string text(n, ' '); mt19937 rng(42);
+  for (auto& ch : text) ch = char('a' + rng() % 26);
+  const vector<string> ps = { "error", "warning", "timeout", "refused",
+                              "denied", "panic", "fatal", "retry" };
+  cout << "find (n = " << n << ")" << endl;
+  size_t count = 0; double ms;
+  auto report = [&](const char* name) {
+    cout << "  " << name << " " << ms << " ms (" << count << ")" << endl;
+  };
+  ms = _time_ms([&]() { count = 0;
+    for (size_t i = text.find("abc"); i != string::npos;
+         i = text.find("abc", i + 1)) ++count; });
+  report("std::string::find     ");
+  ms = _time_ms([&]() { count = 0;
+    for (auto i : find_all(text, "abc")) ++count, (void) i; });
+  report("find_all              ");
+  ms = _time_ms([&]() { count = 0;
+    for (const auto& p : ps)
+      for (size_t i = text.find(p); i != string::npos;
+           i = text.find(p, i + 1)) ++count; });
+  report("std::string::find (8x)");
+  ms = _time_ms([&]() { count = 0;
+    for (auto m : find_any(text, ps)) ++count, (void) m; });
+  report("find_any              ");
+}                                                             //  }}}1
+
+void _bench_distinct()                                        //  {{{1
+{
+  using namespace std;
+
+  const size_t n = size_t(1) << 23;
+  mt19937_64 rng(42); vector<uint64_t> ids;
+  for (size_t i = 0; i < n; ++i) ids.push_back(rng());
+  for (size_t i = 0; i < n; ++i) ids.push_back(ids[rng() % n]);
+  cout << "distinct (" << ids.size() << " ids, " << n << " unique)"
+       << endl;
+  size_t count = 0; double ms;
+  auto report = [&](const char* name, size_t bytes) {
+    cout << "  " << name << " " << ms << " ms, " << (bytes >> 20)
+         << " MiB (" << count << ")" << endl;
+  };
+  unordered_set<uint64_t> seen;
+  ms = _time_ms([&]() { count = 0;
+    for (auto x : filter([&seen](uint64_t x)
+                         { return seen.insert(x).second; }, ids))
+      ++count, (void) x; });
+  report("filter w/ unordered_set",
+         seen.size() * (sizeof(uint64_t) + 2 * sizeof(void*)) +
+         seen.bucket_count() * sizeof(void*));
+  auto run = [&](const char* name, auto set) {
+    size_t bytes = 0;
+    ms = _time_ms([&]() { count = 0;
+      auto d = distinct(ids, std::move(set));
+      auto it = d.begin(), e = d.end();
+      for (; it != e; ++it) ++count;
+      bytes = it.set().bytes(); });
+    report(name, bytes);
+  };
+  run("distinct (exact)       ", FlatSet<uint64_t>(n));
+  run("distinct (bloom, 1%)   ", BlockedBloom<uint64_t>(n, 0.01));
+  run("distinct (cuckoo, .1%) ", CuckooFilter<uint64_t>(n, 0.001));
+}                                                             //  }}}1
+
+int bench()
+{
+  _bench_sort<int32_t>("int32_t"); _bench_sort<int64_t>("int64_t");
+  _bench_search(); _bench_scan(); _bench_find();
+  _bench_distinct();
+  return 0;
+}
+
+int main(int argc, char* argv[])                              //  {{{1
+{
+  using namespace std;
+
+  if (argc > 1 && string(argv[1]) == "bench") return bench();
+
+  const vector<int> a = {1 , 2 ,  3,  4,  5};
+  const deque<int>  b = {6 , 7 ,  8,  9, 10};
+  const vector<int> c = {11, 12, 13, 14, 15};
+
+  {
+    cout <<  "chain(a, b)" << endl;
+    auto xs = chain(a, b);
+    for (auto x : xs) cout << x << " ";
+    cout << endl;
+  }
+
+  {
+    cout <<  "chain(a, chain(b, c))" << endl;
+    auto xs = chain(a, chain(b, c));
+    for (auto x : xs) cout << x << " ";
+    cout << endl;
+  }
+
+  {
+    cout <<  "filter({ x % 2 == 0 }, chain(a, b))" << endl;
+    auto xs = filter([](int x){ return x % 2 == 0; }, chain(a, b));
+    for (auto x : xs) cout << x << " ";
+    cout << endl;
+  }
+
+  {
+    cout <<  "map({ x*x }, chain(a, b))" << endl;
+    auto xs = map([](int x){ return x*x; }, chain(a, b));
+    for (auto x : xs) cout << x << " ";
+    cout << endl;
+  }
+
+  {
+    cout <<  "slice(chain(a, b), 0, -1, 2)" << endl;
+    auto xs = slice(chain(a, b), 0, -1, 2);
+    for (auto x : xs) cout << x << " ";
+    cout << endl;
+  }
+
+  {
+    cout <<  "slice(chain(a, b), 3, 6, 2)" << endl;
+    auto xs = slice(chain(a, b), 3, 6, 2);
+    for (auto x : xs) cout << x << " ";
+    cout << endl;
+  }
+
+  {
+    cout <<  "take_while({ x < 7 }, chain(a, b))" << endl;
+    auto xs = take_while([](int x){ return x < 7; }, chain(a, b));
+    for (auto x : xs) cout << x << " ";
+    cout << endl;
+  }
+
+  {
+    cout <<  "zip(a, b)" << endl;
+    auto xs = zip(a, b);
+    for (auto x : xs) cout << get<0>(x) << "," << get<1>(x) << " ";
+    cout << endl;
+  }
+
+  {
+    cout <<  "zip(map({ x*x }, chain(a, b)), c)" << endl;
+    auto xs = zip(map([](int x){ return x*x; }, chain(a, b)), c);
+    for (auto x : xs) cout << get<0>(x) << "," << get<1>(x) << " ";
+    cout << endl;
+  }
+
+  {
+    cout << "generator(10, i > 0, i--)" << endl;
+    int i = 10;
+    auto g = generator<int>([&i](){ if (i == 0) throw StopIteration();
+                                    return i--; });
+    for (auto x : g) cout << x << " ";
+    cout << endl;
+  }
+
+  {
+    cout << "$generator(37; 1, i < 20, i+=2; 42)" << endl;
+    $generator(gen) {
+      int i = 0;
+      $gbegin(int)
+        $yield(37)
+        for (i = 1; i < 20; i+=2) $yield(i)
+        $yield(42)
+      $gend
+    } g;
+    for (auto x : generator<int>(g)) cout << x << " ";
+    cout << endl;
+  }
+
+  {
+    cout <<  "llist(map({ x*x }, chain(a, b)))" << endl;
+    auto xs = llist(map([](int x){ return x*x; }, chain(a, b)));
+    cout << "xs[3] = " << xs[3] << ", xs[6] = " << xs[6] << endl;
+    for (auto x : xs) cout << x << " ";
+    cout << endl;
+  }
+
+  {
+    cout <<  "llist(1).append({ x++ }) break at > 10" << endl;
+    auto xs = llist<int>(); auto x = 1;
+    xs.append([&x](){ return x++; });
+    for (auto x : xs) {
+      if (x > 10) break;
+      cout << x << " ";
+    }
+    cout << endl;
+  }
+
+  {
+    cout <<  "llist(1).append({ x++ }) stop at > 10" << endl;
+    auto xs = llist<int>(); auto x = 1;
+    xs.append([&x](){ auto y = x++; if(y > 10) throw StopIteration();
+                      return y; });
+    for (auto x : xs) {
+      cout << x << " ";
+    }
+    cout << endl;
+  }
+
+  const vector<int> init = {0,1}; int i = 0;
+  auto fibs = llist(init);
+  fibs.append([&fibs,&i](){ ++i; return fibs[i-1] + fibs[i]; });
+
+  {
+    cout << "fibs" << endl;
+    for (auto x : fibs(10)) cout << x << " ";
+    cout << endl;
+  }
+
+  {
+    cout <<  "llist(map({ x*x }, fibs))" << endl;
+    auto xs = llist(map([](int x){ return x*x; }, fibs))(10);
+    for (auto x : xs) cout << x << " ";
+    cout << endl;
+  }
+
+  {
+    cout << "fibs2" << endl;
+    auto fibs2 = llist(fibs);
+    for (auto x : fibs2(15)) cout << x << " ";
+    cout << endl;
+  }
+
+  {
+    cout << "sliced fibs" << endl;
+    for (auto x : fibs(0, 17, 2)) cout << x << " ";
+    cout << endl;
   }
 
   {
@@ -843,6 +3322,443 @@ int main()                                                    //  {{{1
           ", xs[7]<0> = " << get<1>(xs[7]) << endl;
   }
 
+  {
+    cout << "sorted(chain(c, chain(b, a)), greater)" << endl;
+    auto xs = sorted(chain(c, chain(b, a)), greater<int>());
+    for (auto x : xs) cout << x << " ";
+    cout << endl;
+  }
+
+  {
+    cout << "sorted(map({ (x*7) % 11 - 5 }, chain(a, b)))" << endl;
+    auto xs = sorted(map([](int x){ return (x*7) % 11 - 5; }, chain(a, b)));
+    for (auto x : xs) cout << x << " ";
+    cout << endl;
+  }
+
+  {
+    cout << "radix_sort({ 3.5, -1.25, 0, -7, 2, -0.5 })" << endl;
+    vector<double> xs = { 3.5, -1.25, 0, -7, 2, -0.5 };
+    radix_sort(xs);
+    for (auto x : xs) cout << x << " ";
+    cout << endl;
+  }
+
+  {
+    cout << "sorted, search_index of 300 long doubles (no radix_sort)"
+         << endl;
+    vector<long double> xs;
+    for (int i = 0; i < 300; ++i) xs.push_back((i * 7919 % 300) / 4.0L);
+    auto idx = search_index(xs); size_t n = 0, i = 0;
+    for (auto x : sorted(xs)) n += x == (i++) / 4.0L;
+    cout << n << " " << idx.lower_bound(10.1L) << " "
+         << idx[idx.lower_bound(10.1L)] << endl;
+  }
+
+  {
+    cout << "pdqsort, radix_sort, parallel_merge_sort == std::sort"
+         << endl;
+    mt19937 rng(42); vector<vector<long>> inputs(4);
+    for (long i = 0; i < 200000; ++i) {
+      inputs[0].push_back(static_cast<long>(rng()) - (1L << 31));
+      inputs[1].push_back(i);
+      inputs[2].push_back(-i);
+      inputs[3].push_back(rng() % 7);
+    }
+    for (auto& in : inputs) {
+      auto ys = in, zs = in, ws = in, expected = in;
+      sort(expected.begin(), expected.end());
+      pdqsort(ys.begin(), ys.end()); radix_sort(zs, 3);
+      parallel_merge_sort(ws.begin(), ws.end(), less<long>(), 3);
+      cout << (ys == expected) << (zs == expected) << (ws == expected)
+           << " ";
+    }
+    vector<pair<long, long>> ps, qs;
+    for (long i = 0; i < 300000; ++i) ps.push_back(make_pair(rng() % 100, i));
+    qs = ps;
+    auto by_key = [](const pair<long, long>& x, const pair<long, long>& y)
+                  { return x.first < y.first; };
+    stable_sort(ps.begin(), ps.end(), by_key);
+    parallel_merge_sort(qs.begin(), qs.end(), by_key, 3);
+    cout << "| stable " << (ps == qs);
+    cout << endl;
+  }
+
+  {
+    cout << "search_index(map({ x*x }, chain(b, a))).lower_bound(...)"
+         << endl;
+    auto idx = search_index(map([](int x){ return x*x; }, chain(b, a)));
+    for (auto k : { 0, 1, 2, 49, 50, 100, 101 })
+      cout << idx.lower_bound(k) << " ";
+    cout << "| ";
+    idx.eytzinger();
+    for (auto k : { 0, 1, 2, 49, 50, 100, 101 })
+      cout << idx.lower_bound(k) << " ";
+    cout << "| ";
+    for (auto i : idx.lower_bound_many(chain(a, c))) cout << i << " ";
+    cout << endl;
+  }
+
+  {
+    cout << "search_index: lower_bound(_many) == std::lower_bound" << endl;
+    mt19937 rng(37); vector<unsigned> xs, keys;
+    for (int i = 0; i < 100000; ++i) xs.push_back(rng() % 300000);
+    for (int i = 0; i < 1000; ++i)   keys.push_back(rng() % 300001);
+    auto idx = search_index(xs); auto ys = xs;
+    sort(ys.begin(), ys.end());
+    for (int eytz = 0; eytz < 2; ++eytz) {
+      if (eytz) idx.eytzinger();
+      bool ok = true; auto many = idx.lower_bound_many(keys);
+      for (size_t i = 0; i < keys.size(); ++i) {
+        const size_t j = lower_bound(ys.begin(), ys.end(), keys[i])
+                       - ys.begin();
+        ok = ok && idx.lower_bound(keys[i]) == j && many[i] == j;
+      }
+      cout << ok << " ";
+    }
+    cout << endl;
+  }
+
+  {
+    cout << "DaryHeap<int, 4>: push chain(c, a), pop all" << endl;
+    DaryHeap<int, 4> h;
+    for (auto x : chain(c, a)) h.push(x);
+    while (!h.empty()) cout << h.pop() << " ";
+    cout << endl;
+  }
+
+  {
+    cout << "nsmallest(generator(...), 4), nlargest(map({ x*x }, c), 3), "
+            "top_k(a, 2^40)"
+         << endl;
+    int i = 20;
+    auto g = generator<int>([&i](){ if (i == 0) throw StopIteration();
+                                    return (i-- * 7) % 20; });
+    for (auto x : nsmallest(g, 4)) cout << x << " ";
+    cout << "| ";
+    for (auto x : nlargest(map([](int x){ return x*x; }, c), 3))
+      cout << x << " ";
+    cout << "| ";
+    for (auto x : top_k(a, size_t(1) << 40)) cout << x << " ";
+    cout << endl;
+  }
+
+  {
+    cout << "top_k(chain(b, chain(c, a)), 6, { x/5 }) (stable)" << endl;
+    auto by5 = [](int x, int y){ return x/5 < y/5; };
+    for (auto x : top_k(chain(b, chain(c, a)), 6, by5)) cout << x << " ";
+    cout << endl;
+  }
+
+  {
+    cout << "parallel_top_k == top_k" << endl;
+    mt19937 rng(7); vector<int> xs;
+    for (int i = 0; i < 100000; ++i) xs.push_back(rng() % 100000);
+    auto by10 = [](int x, int y){ return x/10 < y/10; };
+    size_t n1 = 0, n2 = 0;
+    for (auto p : zip(top_k(xs, 50, by10),
+                      parallel_top_k(xs, 50, by10, 3)))
+      n1 += get<0>(p) == get<1>(p);
+    for (auto p : zip(nlargest(xs, 1000),
+                      parallel_top_k(xs, 1000, greater<int>(), 4)))
+      n2 += get<0>(p) == get<1>(p);
+    cout << n1 << " " << n2 << endl;
+  }
+
+  {
+    cout << "memo_map({ x*x }, chain(a, chain(b, a)), 16)" << endl;
+    int calls = 0;
+    auto xs = memo_map([&calls](int x){ ++calls; return x*x; },
+                       chain(a, chain(b, a)), 16);
+    for (auto x : xs) cout << x << " ";
+    const auto s = xs.stats();
+    cout << "| calls = " << calls << ", hits = " << s.hits
+         << ", misses = " << s.misses << ", evictions = " << s.evictions
+         << endl;
+  }
+
+  {
+    cout << "memo_map w/ shared cache on 4 threads" << endl;
+    auto cache = make_shared<MemoCache<int, long>>(1024, true);
+    vector<int> keys;
+    for (int i = 0; i < 40000; ++i) keys.push_back((i * 37) % 3000);
+    vector<long> sums(4);
+    _parallel_for(4, [&](size_t t) {
+      vector<int> ks(keys.begin() + t * 10000,
+                     keys.begin() + (t+1) * 10000);
+      for (auto x : memo_map([](int x){ return long(x) * x; }, ks, cache))
+        sums[t] += x;
+    });
+    long expected = 0; for (auto k : keys) expected += long(k) * k;
+    const auto s = cache->stats();
+    cout << (sums[0] + sums[1] + sums[2] + sums[3] == expected) << " "
+         << (s.hits + s.misses == keys.size()) << " "
+         << (s.evictions > 0) << " " << cache->capacity() << endl;
+  }
+
+  {
+    cout << "windows(chain(a, b), 3), chunks(c, 2)" << endl;
+    for (auto w : windows(chain(a, b), 3)) {
+      for (auto x : w) cout << x << ",";
+      cout << " ";
+    }
+    cout << "| ";
+    for (auto w : chunks(c, 2)) {
+      for (auto x : w) cout << x << ",";
+      cout << " ";
+    }
+    cout << endl;
+  }
+
+  {
+    cout << "windows(generator(10, i > 0, i--), 4)" << endl;
+    int i = 10;
+    auto g = generator<int>([&i](){ if (i == 0) throw StopIteration();
+                                    return i--; });
+    for (auto w : windows(g, 4)) cout << w[0] << "-" << w[3] << " ";
+    cout << endl;
+  }
+
+  {
+    cout << "rolling_{sum,mean,min,max}(map({ (x*7) % 11 }, "
+            "chain(a, b)), 3)" << endl;
+    auto xs = map([](int x){ return (x*7) % 11; }, chain(a, b));
+    for (auto x : xs) cout << x << " ";
+    cout << "| ";
+    for (auto x : rolling_sum(xs, 3)) cout << x << " ";
+    cout << "| ";
+    for (auto x : rolling_mean(xs, 3)) cout << x << " ";
+    cout << "| ";
+    for (auto x : rolling_min(xs, 3)) cout << x << " ";
+    cout << "| ";
+    for (auto x : rolling_max(xs, 3)) cout << x << " ";
+    cout << endl;
+  }
+
+  {
+    cout << "rolling_sum, rolling_mean({ 1e16, 1, 1, 1, 1, 1 }, 2)" << endl;
+    const vector<double> xs = { 1e16, 1, 1, 1, 1, 1 };
+    for (auto x : rolling_sum(xs, 2)) cout << x << " ";
+    cout << "| ";
+    for (auto x : rolling_mean(xs, 2)) cout << x << " ";
+    cout << endl;
+  }
+
+  {
+    cout << "rolling_min/max == min/max of windows" << endl;
+    mt19937 rng(3); vector<int> xs;
+    for (int i = 0; i < 10000; ++i) xs.push_back(rng() % 1000);
+    for (int i = 0; i < 3000; ++i)  xs.push_back(i);
+    bool ok = true;
+    for (size_t n : { 1, 2, 7, 64, 1000 }) {
+      for (auto p : zip(windows(xs, n), zip(rolling_min(xs, n),
+                                            rolling_max(xs, n)))) {
+        auto w = get<0>(p);
+        ok = ok && *min_element(w.begin(), w.end()) == get<0>(get<1>(p))
+                && *max_element(w.begin(), w.end()) == get<1>(get<1>(p));
+      }
+    }
+    cout << ok << endl;
+  }
+
+  {
+    cout << "windows, chunks, rolling_{sum,min}(a, 2^40)" << endl;
+    const size_t n = size_t(1) << 40; size_t k = 0;
+    for (auto w : windows(a, n)) ++k, (void) w;
+    cout << k << " | ";
+    for (auto w : chunks(a, n)) cout << w.size() << " ";
+    cout << "| ";
+    for (auto x : rolling_sum(a, n)) cout << x << " ";
+    for (auto x : rolling_min(a, n)) cout << x << " ";
+    cout << endl;
+  }
+
+  {
+    cout << "scan(+, 0, filter({ x % 2 == 1 }, chain(a, b))), fold(*, 1, a)"
+         << endl;
+    auto xs = scan(plus<int>(), 0,
+                   filter([](int x){ return x % 2 == 1; }, chain(a, b)));
+    for (auto x : xs) cout << x << " ";
+    cout << "| " << fold(multiplies<int>(), 1, a) << endl;
+  }
+
+  {
+    cout << "scan(max, 0, map({ (x*7) % 11 }, c)), take_while over scan"
+         << endl;
+    auto mx = [](int x, int y){ return max(x, y); };
+    for (auto x : scan(mx, 0, map([](int x){ return (x*7) % 11; }, c)))
+      cout << x << " ";
+    cout << "| ";
+    for (auto x : take_while([](int x){ return x < 30; },
+                             scan(plus<int>(), 0, chain(a, b))))
+      cout << x << " ";
+    cout << endl;
+  }
+
+  {
+    cout << "parallel_scan, parallel_fold == scan, fold; of {}" << endl;
+    mt19937 rng(11); vector<int> xs; vector<double> ys;
+    for (int i = 0; i < 300001; ++i) {
+      xs.push_back(int(rng() % 2001) - 1000); ys.push_back(rng() % 100);
+    }
+    auto mx = [](int x, int y){ return max(x, y); };
+    for (size_t t : { 1, 3, 4 }) {
+      auto s1 = parallel_scan(plus<int>(), 7, xs, t);
+      auto s2 = parallel_scan(mx, -5000, xs, t);
+      auto s3 = parallel_scan(plus<double>(), 0.5, ys, t);
+      size_t n = 0;
+      for (auto p : zip(s1, scan(plus<int>(), 7, xs)))
+        n += get<0>(p) == get<1>(p);
+      for (auto p : zip(s2, scan(mx, -5000, xs)))
+        n += get<0>(p) == get<1>(p);
+      for (auto p : zip(s3, scan(plus<double>(), 0.5, ys)))
+        n += get<0>(p) == get<1>(p);
+      cout << (n == 3 * xs.size()) << " "
+           << (parallel_fold(plus<int>(), 7, xs, t) ==
+               fold(plus<int>(), 7, xs)) << " ";
+    }
+    cout << "| " << parallel_scan(plus<int>(), 0, vector<int>{}).size()
+         << " " << parallel_fold(plus<int>(), 7, vector<int>{}) << endl;
+  }
+
+  {
+    cout << "find_all(\"abracadabra, aaaa\", \"abra\" | \"aa\" | \"a\")"
+         << endl;
+    const string text = "abracadabra, aaaa";
+    for (auto p : { "abra", "aa", "a" }) {
+      for (auto i : find_all(text, p)) cout << i << " ";
+      cout << "| ";
+    }
+    cout << endl;
+  }
+
+  {
+    cout << "find_any(\"ushers and his hers\", he, she, his, hers)"
+         << endl;
+    const string text = "ushers and his hers";
+    for (auto m : find_any(text, { "he", "she", "his", "hers" }))
+      cout << get<0>(m) << ":" << get<1>(m) << " ";
+    AhoCorasick ac(vector<string>{ "he", "she", "his", "hers" });
+    cout << "| ";
+    for (auto m : find_any(text, make_shared<const AhoCorasick>(ac)))
+      cout << get<0>(m) << ":" << get<1>(m) << " ";
+    cout << endl;
+  }
+
+  {
+    cout << "find_all, find_any == naive search" << endl;
+    mt19937 rng(5); string text;
+    for (int i = 0; i < 20000; ++i) text += "abcd"[rng() % 4];
+    const vector<string> ps = { "abca", "ab", "d", "cab", "abcabd",
+                                "dddd", "bcab" };
+    size_t ok = 0, n = 0; vector<tuple<size_t, size_t>> expected;
+    for (size_t j = 0; j < ps.size(); ++j) {
+      vector<size_t> naive;
+      for (size_t i = text.find(ps[j]); i != string::npos;
+           i = text.find(ps[j], i + 1))
+        naive.push_back(i);
+      for (auto i : naive) expected.push_back(make_tuple(i, j));
+      for (auto p : zip(naive, find_all(Span<char>(text.data(),
+                                                   text.size()), ps[j])))
+        ok += get<0>(p) == get<1>(p);
+      n += naive.size();
+    }
+    vector<tuple<size_t, size_t>> ms;
+    for (auto m : find_any(text, ps)) ms.push_back(m);
+    sort(ms.begin(), ms.end()); sort(expected.begin(), expected.end());
+    cout << (ok == n) << " " << (ms == expected) << " " << (n > 1000)
+         << endl;
+  }
+
+  {
+    cout << "distinct(chain(a, chain(map({ x % 4 }, b), a))): exact, "
+            "bloom, cuckoo" << endl;
+    auto xs = chain(a, chain(map([](int x){ return x % 4; }, b), a));
+    for (auto x : distinct(xs)) cout << x << " ";
+    cout << "| ";
+    for (auto x : distinct(xs, BlockedBloom<int>(100, 0.01))) cout << x << " ";
+    cout << "| ";
+    for (auto x : distinct(xs, CuckooFilter<int>(100))) cout << x << " ";
+    cout << endl;
+  }
+
+  {
+    cout << "distinct w/ bloom, cuckoo: no false negatives, few false "
+            "positives" << endl;
+    mt19937_64 rng(13); vector<uint64_t> ids;
+    for (int i = 0; i < 100000; ++i) ids.push_back(rng());
+    for (int i = 0; i < 100000; ++i) ids.push_back(ids[rng() % 100000]);
+    size_t exact = 0, bloom = 0, cuckoo = 0;
+    for (auto x : distinct(ids)) ++exact, (void) x;
+    for (auto x : distinct(ids, BlockedBloom<uint64_t>(100000, 0.01)))
+      ++bloom, (void) x;
+    for (auto x : distinct(ids, CuckooFilter<uint64_t>(100000, 0.001)))
+      ++cuckoo, (void) x;
+    cout << exact << " " << (bloom <= exact && bloom > exact - 2000) << " "
+         << (cuckoo <= exact && cuckoo > exact - 200) << endl;
+  }
+
+  {
+    cout << "bloom w/ 2^13 blocks; cuckoo for 1000 w/ 5000: saturated, "
+            "no throw" << endl;
+    mt19937_64 rng(17); vector<uint64_t> ids;
+    for (int i = 0; i < 437560; ++i) ids.push_back(rng());
+    BlockedBloom<uint64_t> bloom(ids.size(), 0.01);
+    size_t fresh = 0;
+    for (auto x : ids) fresh += bloom.insert(x);
+    cout << (bloom.bytes() == 8192 * 64) << " "
+         << (fresh > ids.size() - ids.size() / 100) << " | ";
+    ids.resize(5000);
+    CuckooFilter<uint64_t> cuckoo(1000); size_t n = 0; fresh = 0;
+    for (auto x : ids) fresh += cuckoo.insert(x);
+    auto d = distinct(ids, CuckooFilter<uint64_t>(1000));
+    auto it = d.begin(), e = d.end();
+    for (; it != e; ++it) ++n;
+    cout << cuckoo.saturated() << " " << (fresh > 4900) << " "
+         << (n == fresh) << " " << it.set().saturated() << endl;
+  }
+
+  {
+    cout << "distinct({ 1, 2, 3, 1, 2, 4, 5 }): copied iterator" << endl;
+    const vector<int> xs = { 1, 2, 3, 1, 2, 4, 5 };
+    auto d = distinct(xs); auto it = d.begin(), e = d.end();
+    ++it; auto it2 = it;
+    for (; it != e; ++it) cout << *it << " ";
+    cout << "| ";
+    for (; it2 != e; ++it2) cout << *it2 << " ";
+    cout << "| ";
+    try { d.begin(); } catch (const logic_error&) { cout << "once"; }
+    cout << endl;
+  }
+
+  {
+    cout << "cx: primes, fibs, popcount & crc32 tables at compile time"
+         << endl;
+    using namespace cx_example;
+    static constexpr auto ns     = cx::iota<60>();
+    static constexpr auto primes =
+      cx::filter<cx::count_if(is_prime, ns)>(is_prime, ns);
+    static constexpr auto fibs   =
+      cx::recurrence<40>(add, std::array<uint64_t, 2>{{ 0, 1 }});
+    static constexpr auto small  =
+      cx::take_while<cx::count_while(lt_1000, fibs)>(lt_1000, fibs);
+    static constexpr auto bits   = cx::map(popcount, cx::iota<256>());
+    static constexpr auto crc32  =
+      cx::map(crc32_entry, cx::iota<256, uint32_t>());
+    static constexpr auto first  = cx::find(gt_300, fibs);
+    static_assert(primes.size() == 17 && primes[16] == 59, "primes");
+    static_assert(fibs[39] == 63245986 && small.size() == 17, "fibs");
+    static_assert(bits[255] == 8 && crc32[1] == 0x77073096, "tables");
+    static_assert(first.has_value() && *first == 377, "find");
+    for (auto x : primes) cout << x << " ";
+    cout << "| ";
+    for (auto x : cx::slice<0, -1, 2>(small)) cout << x << " ";
+    cout << "| ";
+    for (auto x : cx::slice<0, 8>(bits)) cout << int(x) << " ";
+    cout << "| " << hex << crc32[255] << dec << " | "
+         << first.value_or(0) << endl;
+  }
+
   /* ... TODO ... */
 
   return 0;